@@ -0,0 +1,255 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Heuristic computer player.                                               */
+/*   Board rating from: https://codemyroad.wordpress.com/2013/04/14/          */
+/*   tetris-ai-the-near-perfect-player/                                       */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "ai_player.hpp"
+#include <limits.h>
+
+namespace stc
+{
+
+AiPlayer::AiPlayer()
+{
+    reset();
+}
+
+// Forget the current plan
+void AiPlayer::reset()
+{
+    mPieces = -1;
+    mRotations = 0;
+}
+
+// Send the events for the next step of the falling tetromino
+void AiPlayer::play(Game &game)
+{
+    if (game.isOver())
+    {
+        send(game, Game::EVENT_RESTART);
+        reset();
+        return;
+    }
+    if (game.isPaused())
+    {
+        return;
+    }
+
+    // Choose a placement for every new tetromino
+    if (game.stats().totalPieces != mPieces)
+    {
+        plan(game);
+    }
+
+    // Rotate first, then move to the target column and drop
+    const Game::StcTetromino &block = game.fallingBlock();
+    if (!sameCells(block, mTarget) && (mRotations < MAX_ROTATIONS))
+    {
+        ++mRotations;
+        send(game, Game::EVENT_ROTATE_CW);
+    }
+    else if (block.x < mTarget.x)
+    {
+        send(game, Game::EVENT_MOVE_RIGHT);
+    }
+    else if (block.x > mTarget.x)
+    {
+        send(game, Game::EVENT_MOVE_LEFT);
+    }
+    else
+    {
+        send(game, Game::EVENT_DROP);
+    }
+}
+
+// Press and release a key, so there is no autoshift
+void AiPlayer::send(Game &game, int event)
+{
+    game.onEventStart(event);
+    game.onEventEnd(event);
+}
+
+// Choose the best placement for the falling tetromino
+void AiPlayer::plan(Game &game)
+{
+    STC_TRACE_SPAN("aiPlan");
+    int i, j;
+    StcBoard board;
+    for (i = 0; i < Game::BOARD_TILEMAP_WIDTH; ++i)
+    {
+        for (j = 0; j < Game::BOARD_TILEMAP_HEIGHT; ++j)
+        {
+            board[i][j] = (game.getCell(i, j) != Game::EMPTY_CELL);
+        }
+    }
+
+    const Game::StcTetromino &falling = game.fallingBlock();
+    Game::StcTetromino block = falling;
+    int best = INT_MIN;
+
+    mTarget = falling;
+    mPieces = game.stats().totalPieces;
+    mRotations = 0;
+
+    for (int rotation = 0; rotation <= MAX_ROTATIONS; ++rotation)
+    {
+        if (rotation > 0)
+        {
+            if (block.type == Game::TETROMINO_O)
+            {
+                break;
+            }
+            Game::rotateCells(&block, true);
+        }
+        for (int x = 1 - Game::TETROMINO_SIZE; x < Game::BOARD_TILEMAP_WIDTH; ++x)
+        {
+            // The tetromino is rotated in place and moved along its row
+            int step = (x < falling.x)? -1 : 1;
+            bool reachable = fits(board, block, falling.x, falling.y);
+            for (i = falling.x; reachable && (i != x); i += step)
+            {
+                reachable = fits(board, block, i + step, falling.y);
+            }
+            if (!reachable)
+            {
+                continue;
+            }
+
+            int y = falling.y;
+            while (fits(board, block, x, y + 1))
+            {
+                ++y;
+            }
+            int rating = rate(board, block, x, y);
+            if (rating > best)
+            {
+                best = rating;
+                mTarget = block;
+                mTarget.x = x;
+                mTarget.y = y;
+            }
+        }
+    }
+}
+
+// Return true if the tetromino fits on the board at the given position
+bool AiPlayer::fits(const StcBoard &board, const Game::StcTetromino &block, int x, int y)
+{
+    for (int i = 0; i < block.size; ++i)
+    {
+        for (int j = 0; j < block.size; ++j)
+        {
+            if (block.cells[i][j] != Game::EMPTY_CELL)
+            {
+                if ((x + i < 0) || (x + i >= Game::BOARD_TILEMAP_WIDTH)
+                        || (y + j >= Game::BOARD_TILEMAP_HEIGHT) || board[x + i][y + j])
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Return true if both tetrominoes have the same cells
+bool AiPlayer::sameCells(const Game::StcTetromino &a, const Game::StcTetromino &b)
+{
+    for (int i = 0; i < Game::TETROMINO_SIZE; ++i)
+    {
+        for (int j = 0; j < Game::TETROMINO_SIZE; ++j)
+        {
+            if (a.cells[i][j] != b.cells[i][j])
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Rate the board after locking the tetromino at the given position
+int AiPlayer::rate(const StcBoard &board, const Game::StcTetromino &block, int x, int y)
+{
+    int i, j;
+    StcBoard locked;
+    for (i = 0; i < Game::BOARD_TILEMAP_WIDTH; ++i)
+    {
+        for (j = 0; j < Game::BOARD_TILEMAP_HEIGHT; ++j)
+        {
+            locked[i][j] = board[i][j];
+        }
+    }
+    for (i = 0; i < block.size; ++i)
+    {
+        for (j = 0; j < block.size; ++j)
+        {
+            if (block.cells[i][j] != Game::EMPTY_CELL)
+            {
+                locked[x + i][y + j] = true;
+            }
+        }
+    }
+
+    // Remove the filled rows
+    int lines = 0;
+    for (j = 1; j < Game::BOARD_TILEMAP_HEIGHT; ++j)
+    {
+        bool filled = true;
+        for (i = 0; filled && (i < Game::BOARD_TILEMAP_WIDTH); ++i)
+        {
+            filled = locked[i][j];
+        }
+        if (filled)
+        {
+            for (i = 0; i < Game::BOARD_TILEMAP_WIDTH; ++i)
+            {
+                for (int k = j; k > 0; --k)
+                {
+                    locked[i][k] = locked[i][k - 1];
+                }
+            }
+            ++lines;
+        }
+    }
+
+    // Column heights and holes
+    int height = 0;
+    int holes = 0;
+    int bumpiness = 0;
+    int lastHeight = 0;
+    for (i = 0; i < Game::BOARD_TILEMAP_WIDTH; ++i)
+    {
+        j = 0;
+        while ((j < Game::BOARD_TILEMAP_HEIGHT) && !locked[i][j])
+        {
+            ++j;
+        }
+        int columnHeight = Game::BOARD_TILEMAP_HEIGHT - j;
+        for (; j < Game::BOARD_TILEMAP_HEIGHT; ++j)
+        {
+            if (!locked[i][j])
+            {
+                ++holes;
+            }
+        }
+        height += columnHeight;
+        if (i > 0)
+        {
+            bumpiness += (columnHeight > lastHeight)? columnHeight - lastHeight
+                                                    : lastHeight - columnHeight;
+        }
+        lastHeight = columnHeight;
+    }
+
+    return WEIGHT_HEIGHT * height + WEIGHT_LINES * lines
+           + WEIGHT_HOLES * holes + WEIGHT_BUMPINESS * bumpiness;
+}
+}
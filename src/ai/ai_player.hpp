@@ -0,0 +1,62 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Heuristic computer player.                                               */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#ifndef STC_AI_PLAYER_HPP_
+#define STC_AI_PLAYER_HPP_
+
+#include "../game.hpp"
+
+namespace stc
+{
+
+// Computer player that sends the same events as a keyboard player.
+// For every new tetromino it tries all rotations and columns, rates the
+// resulting boards and moves the tetromino one step per game update.
+class AiPlayer
+{
+public:
+    // Weights of the board features (in hundredths)
+    static const int WEIGHT_HEIGHT    = -51;  // sum of the column heights
+    static const int WEIGHT_LINES     = 76;   // cleared rows
+    static const int WEIGHT_HOLES     = -36;  // empty cells below filled cells
+    static const int WEIGHT_BUMPINESS = -18;  // height differences of neighbor columns
+
+    // Maximum number of rotations tried before moving the tetromino
+    static const int MAX_ROTATIONS = 3;
+
+    AiPlayer();
+
+    // Forget the current plan, call it when a new game starts
+    void reset();
+
+    // Send the events for the next step to [game], call it once per update
+    void play(Game &game);
+
+    // Return true if both tetrominoes have the same cells
+    static bool sameCells(const Game::StcTetromino &a, const Game::StcTetromino &b);
+
+private:
+
+    // Cells of the board, true if filled
+    typedef bool StcBoard[Game::BOARD_TILEMAP_WIDTH][Game::BOARD_TILEMAP_HEIGHT];
+
+    Game::StcTetromino mTarget; // falling tetromino on the chosen placement
+    int  mPieces;               // total pieces when the placement was chosen
+    int  mRotations;            // rotations sent for the current tetromino
+
+    void plan(Game &game);
+    void send(Game &game, int event);
+
+    static bool fits(const StcBoard &board, const Game::StcTetromino &block, int x, int y);
+    static int rate(const StcBoard &board, const Game::StcTetromino &block, int x, int y);
+};
+}
+
+#endif // STC_AI_PLAYER_HPP_
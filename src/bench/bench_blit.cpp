@@ -0,0 +1,170 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Blit path benchmark.                                                     */
+/*   Measures blits per second and frame time drawing a full frame with the   */
+/*   images as loaded by IMG_Load, converted to the screen format, and        */
+/*   converted with RLE acceleration (the path used by PlatformSdl).          */
+/*                                                                            */
+/*   Run it from the bin folder, it can run without a display:                */
+/*       SDL_VIDEODRIVER=dummy ./bench_blit [frames]                          */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "../sdl/sdl_game.hpp"
+#include <SDL_image.h>
+#include <cstdio>
+#include <cstdlib>
+
+// Same layout as the SDL platform
+static const int SCREEN_WIDTH  = stc::PlatformSdl::SCREEN_WIDTH;
+static const int SCREEN_HEIGHT = stc::PlatformSdl::SCREEN_HEIGHT;
+static const int TILE_SIZE     = stc::PlatformSdl::TILE_SIZE;
+static const int BOARD_X       = stc::PlatformSdl::BOARD_X;
+static const int BOARD_Y       = stc::PlatformSdl::BOARD_Y;
+static const int NUMBER_WIDTH  = stc::PlatformSdl::NUMBER_WIDTH;
+static const int NUMBER_HEIGHT = stc::PlatformSdl::NUMBER_HEIGHT;
+
+// Digits drawn by the eleven statistic counters
+static const int FRAME_DIGITS = stc::PlatformSdl::LEVEL_LENGTH + stc::PlatformSdl::LINES_LENGTH
+                                + stc::PlatformSdl::SCORE_LENGTH + stc::PlatformSdl::PIECES_LENGTH
+                                + stc::Game::TETROMINO_TYPES * stc::PlatformSdl::TETROMINO_LENGTH;
+
+// Frames drawn before measuring
+static const int WARMUP_FRAMES = 50;
+
+// Images used by one blit path
+struct BlitPath
+{
+    const char  *name;
+    SDL_Surface *tiles;
+    SDL_Surface *back;
+    SDL_Surface *numbers;
+};
+
+// Draw a frame like a full redraw of a board filled with tiles,
+// return the number of blits used
+static int drawFrame(SDL_Surface *screen, const BlitPath &path)
+{
+    SDL_Rect recSource;
+    SDL_Rect recDestine;
+    int blits = 0;
+
+    SDL_BlitSurface(path.back, NULL, screen, NULL);
+    ++blits;
+
+    recSource.w = TILE_SIZE + 1;
+    recSource.h = TILE_SIZE + 1;
+    for (int i = 0; i < stc::Game::BOARD_TILEMAP_WIDTH; ++i)
+    {
+        for (int j = 0; j < stc::Game::BOARD_TILEMAP_HEIGHT; ++j)
+        {
+            recSource.x = (Sint16)(TILE_SIZE * (1 + (i + j) % stc::Game::TETROMINO_TYPES));
+            recSource.y = (Sint16)((TILE_SIZE + 1) * ((i * j) % 2));
+            recDestine.x = (Sint16)(BOARD_X + TILE_SIZE * i);
+            recDestine.y = (Sint16)(BOARD_Y + TILE_SIZE * j);
+            SDL_BlitSurface(path.tiles, &recSource, screen, &recDestine);
+            ++blits;
+        }
+    }
+
+    recSource.w = NUMBER_WIDTH;
+    recSource.h = NUMBER_HEIGHT;
+    for (int k = 0; k < FRAME_DIGITS; ++k)
+    {
+        recSource.x = (Sint16)(NUMBER_WIDTH * (k % 10));
+        recSource.y = (Sint16)(NUMBER_HEIGHT * (k % 8));
+        recDestine.x = (Sint16)(NUMBER_WIDTH * (k % 25));
+        recDestine.y = (Sint16)(NUMBER_HEIGHT * (k / 25));
+        SDL_BlitSurface(path.numbers, &recSource, screen, &recDestine);
+        ++blits;
+    }
+    return blits;
+}
+
+// Convert an image to the screen format without RLE acceleration
+static SDL_Surface *displayFormat(SDL_Surface *image)
+{
+    SDL_Surface *converted = SDL_DisplayFormat(image);
+    if (converted != NULL && (image->flags & SDL_SRCCOLORKEY) != 0)
+    {
+        SDL_SetColorKey(converted, SDL_SRCCOLORKEY, converted->format->colorkey);
+    }
+    return converted;
+}
+
+int main(int argc, char **argv)
+{
+    int frames = (argc > 1)? atoi(argv[1]) : 2000;
+    if (frames <= 0)
+    {
+        fprintf(stderr, "usage: %s [frames]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (SDL_Init(SDL_INIT_VIDEO) < 0)
+    {
+        fprintf(stderr, "SDL_Init: %s\n", SDL_GetError());
+        return EXIT_FAILURE;
+    }
+    SDL_Surface *screen = SDL_SetVideoMode(SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_SWSURFACE);
+    if (screen == NULL)
+    {
+        fprintf(stderr, "SDL_SetVideoMode: %s\n", SDL_GetError());
+        SDL_Quit();
+        return EXIT_FAILURE;
+    }
+
+    BlitPath paths[3];
+    paths[0].name = "raw";
+    paths[0].tiles = IMG_Load(STC_BMP_TILE_BLOCKS);
+    paths[0].back = IMG_Load(STC_BMP_BACKGROUND);
+    paths[0].numbers = IMG_Load(STC_BMP_NUMBERS);
+    if (paths[0].tiles == NULL || paths[0].back == NULL || paths[0].numbers == NULL)
+    {
+        fprintf(stderr, "can't load images, run from the bin folder\n");
+        SDL_Quit();
+        return EXIT_FAILURE;
+    }
+    paths[1].name = "display";
+    paths[1].tiles = displayFormat(paths[0].tiles);
+    paths[1].back = displayFormat(paths[0].back);
+    paths[1].numbers = displayFormat(paths[0].numbers);
+    paths[2].name = "display+rle";
+    paths[2].tiles = stc::PlatformSdl::loadImage(STC_BMP_TILE_BLOCKS, false);
+    paths[2].back = stc::PlatformSdl::loadImage(STC_BMP_BACKGROUND, true);
+    paths[2].numbers = stc::PlatformSdl::loadImage(STC_BMP_NUMBERS, false);
+
+    printf("%-12s %10s %12s %14s\n", "path", "frames", "ms/frame", "blits/s");
+    for (int p = 0; p < 3; ++p)
+    {
+        for (int f = 0; f < WARMUP_FRAMES; ++f)
+        {
+            drawFrame(screen, paths[p]);
+        }
+
+        long blits = 0;
+        Uint32 start = SDL_GetTicks();
+        for (int f = 0; f < frames; ++f)
+        {
+            blits += drawFrame(screen, paths[p]);
+        }
+        Uint32 elapsed = SDL_GetTicks() - start;
+        if (elapsed == 0)
+        {
+            elapsed = 1;
+        }
+        printf("%-12s %10d %12.4f %14.0f\n", paths[p].name, frames,
+               (double)elapsed / frames, 1000.0 * blits / elapsed);
+
+        SDL_FreeSurface(paths[p].tiles);
+        SDL_FreeSurface(paths[p].back);
+        SDL_FreeSurface(paths[p].numbers);
+    }
+
+    SDL_Quit();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,299 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Environment stepping benchmark.                                          */
+/*   Steps batches of seeded games with random actions through VecEnv and     */
+/*   through a loop of Game::update calls that builds the same observations   */
+/*   with getCell, and reports game steps per second for every batch size.    */
+/*   Also steps the batches with random legal placements, a tetromino per     */
+/*   step, with the legality masks written every step. Then measures the      */
+/*   observations of a batch alone: packed and expanded to bytes and floats   */
+/*   by ObsEncoder, against getCell calls.                                    */
+/*                                                                            */
+/*   Usage: ./bench_env [steps] [results.json]                                */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "../env/vec_env.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using stc::Game;
+using stc::VecEnv;
+
+// Batch sizes measured
+static const int BATCHES[] = { 1, 16, 256 };
+static const int BATCH_COUNT = (int)(sizeof(BATCHES) / sizeof(BATCHES[0]));
+
+// Random actions, the same for both loops
+static void randomActions(unsigned int &state, int *actions, int count)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        state = state * 1103515245u + 12345u;
+        actions[i] = (int)((state >> 16) % VecEnv::ACTION_COUNT);
+    }
+}
+
+// Step [count] games [steps] times with VecEnv, return the elapsed microseconds
+static unsigned long runVecEnv(int count, int steps, long &checksum)
+{
+    std::vector<uint8_t> board(count * VecEnv::BOARD_SIZE);
+    std::vector<int32_t> pieces(2 * count);
+    std::vector<float> rewards(count);
+    std::vector<uint8_t> dones(count);
+    std::vector<unsigned int> seeds(count);
+    std::vector<int> actions(count);
+    for (int i = 0; i < count; ++i)
+    {
+        seeds[i] = i + 1;
+    }
+
+    VecEnv env(count);
+    stc::StcEnvBuffers buffers = { &board[0], &pieces[0], &rewards[0], &dones[0], NULL };
+    env.setBuffers(buffers);
+    env.reset(&seeds[0]);
+
+    unsigned int state = 1;
+    unsigned long start = stc::FrameProfiler::now();
+    for (int s = 0; s < steps; ++s)
+    {
+        randomActions(state, &actions[0], count);
+        env.step(&actions[0]);
+        checksum += board[s % board.size()] + dones[s % count];
+    }
+    return stc::FrameProfiler::now() - start;
+}
+
+// Step [count] games [steps] times with random legal placements, return the
+// elapsed microseconds
+static unsigned long runPlacements(int count, int steps, long &checksum)
+{
+    std::vector<uint8_t> board(count * VecEnv::BOARD_SIZE);
+    std::vector<int32_t> pieces(2 * count);
+    std::vector<float> rewards(count);
+    std::vector<uint8_t> dones(count);
+    std::vector<uint8_t> masks(count * Game::PLACEMENT_COUNT);
+    std::vector<unsigned int> seeds(count);
+    std::vector<int> actions(count);
+    for (int i = 0; i < count; ++i)
+    {
+        seeds[i] = i + 1;
+    }
+
+    VecEnv env(count);
+    stc::StcEnvBuffers buffers = { &board[0], &pieces[0], &rewards[0], &dones[0], &masks[0] };
+    env.setBuffers(buffers);
+    env.setActionSpace(VecEnv::ACTIONS_PLACEMENT);
+    env.reset(&seeds[0]);
+
+    unsigned int state = 1;
+    unsigned long start = stc::FrameProfiler::now();
+    for (int s = 0; s < steps; ++s)
+    {
+        // Start from a random placement and take the next legal one
+        randomActions(state, &actions[0], count);
+        for (int i = 0; i < count; ++i)
+        {
+            const uint8_t *mask = &masks[i * Game::PLACEMENT_COUNT];
+            int action = (actions[i] * 7) % Game::PLACEMENT_COUNT;
+            for (int k = 0; k < Game::PLACEMENT_COUNT && mask[action] == 0; ++k)
+            {
+                action = (action + 1) % Game::PLACEMENT_COUNT;
+            }
+            actions[i] = action;
+        }
+        env.step(&actions[0]);
+        checksum += board[s % board.size()] + dones[s % count];
+    }
+    return stc::FrameProfiler::now() - start;
+}
+
+// Step [count] games [steps] times with a loop of Game::update calls,
+// return the elapsed microseconds
+static unsigned long runGames(int count, int steps, long &checksum)
+{
+    static const int EVENTS[VecEnv::ACTION_COUNT] =
+    {
+        Game::EVENT_NONE, Game::EVENT_MOVE_LEFT, Game::EVENT_MOVE_RIGHT,
+        Game::EVENT_MOVE_DOWN, Game::EVENT_ROTATE_CW, Game::EVENT_DROP
+    };
+    std::vector<uint8_t> board(count * VecEnv::BOARD_SIZE);
+    std::vector<int32_t> pieces(2 * count);
+    std::vector<stc::PlatformHeadless> platforms(count);
+    std::vector<Game> games(count);
+    std::vector<int> actions(count);
+    for (int i = 0; i < count; ++i)
+    {
+        platforms[i].seed(i + 1);
+        games[i].init(&platforms[i]);
+    }
+
+    unsigned int state = 1;
+    unsigned long start = stc::FrameProfiler::now();
+    for (int s = 0; s < steps; ++s)
+    {
+        randomActions(state, &actions[0], count);
+        for (int g = 0; g < count; ++g)
+        {
+            Game &game = games[g];
+            if (actions[g] != VecEnv::ACTION_NONE)
+            {
+                game.onEventStart(EVENTS[actions[g]]);
+                game.onEventEnd(EVENTS[actions[g]]);
+            }
+            game.update();
+            if (game.isOver())
+            {
+                game.init(&platforms[g]);
+            }
+
+            // The same observation as VecEnv, through the public API
+            uint8_t *cells = &board[g * VecEnv::BOARD_SIZE];
+            uint8_t *falling = cells + VecEnv::HEIGHT * VecEnv::WIDTH;
+            const Game::StcTetromino &block = game.fallingBlock();
+            for (int j = 0; j < VecEnv::HEIGHT; ++j)
+            {
+                for (int i = 0; i < VecEnv::WIDTH; ++i)
+                {
+                    int x = i - block.x;
+                    int y = j - block.y;
+                    cells[j * VecEnv::WIDTH + i] = (game.getCell(i, j) != Game::EMPTY_CELL)? 1 : 0;
+                    falling[j * VecEnv::WIDTH + i] = (x >= 0 && x < block.size && y >= 0 && y < block.size
+                                                      && block.cells[x][y] != Game::EMPTY_CELL)? 1 : 0;
+                }
+            }
+            pieces[2 * g] = block.type;
+            pieces[2 * g + 1] = game.nextBlock().type;
+        }
+        checksum += board[s % board.size()];
+    }
+    return stc::FrameProfiler::now() - start;
+}
+
+// Build the observations of [count] games [steps] times with ObsEncoder and
+// with getCell, write the boards per second in [rates] (bytes, floats and
+// getCell)
+static void runObservations(int count, int steps, long &checksum, double *rates)
+{
+    std::vector<stc::PlatformHeadless> platforms(count);
+    std::vector<Game> games(count);
+    std::vector<stc::StcPackedObs> packed(count);
+    std::vector<uint8_t> bytes(count * VecEnv::BOARD_SIZE);
+    std::vector<float> floats(count * VecEnv::BOARD_SIZE);
+
+    // Play the games for a while, so the boards aren't empty
+    for (int i = 0; i < count; ++i)
+    {
+        platforms[i].seed(i + 1);
+        games[i].init(&platforms[i]);
+        for (int f = 0; f < 20 * i; ++f)
+        {
+            games[i].update();
+        }
+    }
+
+    unsigned long start = stc::FrameProfiler::now();
+    for (int s = 0; s < steps; ++s)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            stc::ObsEncoder::encode(games[i], packed[i]);
+        }
+        stc::ObsEncoder::expand(&packed[0], count, &bytes[0]);
+        checksum += bytes[s % bytes.size()];
+    }
+    rates[0] = 1e6 * count * steps / (stc::FrameProfiler::now() - start + 1);
+
+    start = stc::FrameProfiler::now();
+    for (int s = 0; s < steps; ++s)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            stc::ObsEncoder::encode(games[i], packed[i]);
+        }
+        stc::ObsEncoder::expand(&packed[0], count, &floats[0]);
+        checksum += (long)floats[s % floats.size()];
+    }
+    rates[1] = 1e6 * count * steps / (stc::FrameProfiler::now() - start + 1);
+
+    start = stc::FrameProfiler::now();
+    for (int s = 0; s < steps; ++s)
+    {
+        for (int g = 0; g < count; ++g)
+        {
+            Game &game = games[g];
+            float *cells = &floats[g * VecEnv::BOARD_SIZE];
+            float *falling = cells + VecEnv::HEIGHT * VecEnv::WIDTH;
+            const Game::StcTetromino &block = game.fallingBlock();
+            for (int j = 0; j < VecEnv::HEIGHT; ++j)
+            {
+                for (int i = 0; i < VecEnv::WIDTH; ++i)
+                {
+                    int x = i - block.x;
+                    int y = j - block.y;
+                    cells[j * VecEnv::WIDTH + i] = (game.getCell(i, j) != Game::EMPTY_CELL)? 1.0f : 0.0f;
+                    falling[j * VecEnv::WIDTH + i] = (x >= 0 && x < block.size && y >= 0 && y < block.size
+                                                      && block.cells[x][y] != Game::EMPTY_CELL)? 1.0f : 0.0f;
+                }
+            }
+        }
+        checksum += (long)floats[s % floats.size()];
+    }
+    rates[2] = 1e6 * count * steps / (stc::FrameProfiler::now() - start + 1);
+}
+
+int main(int argc, char **argv)
+{
+    int steps = (argc > 1)? atoi(argv[1]) : 2000;
+    FILE *output = stdout;
+    if (steps <= 0)
+    {
+        fprintf(stderr, "usage: %s [steps] [results.json]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (argc > 2 && (output = fopen(argv[2], "w")) == NULL)
+    {
+        fprintf(stderr, "can't write %s\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+
+    long checksum = 0;
+    fprintf(output, "{\n  \"benchmark\": \"bench_env\",\n  \"steps\": %d,\n  \"results\": [\n", steps);
+    fprintf(stderr, "%8s %16s %16s %16s\n", "batch", "vecenv steps/s", "loop steps/s", "placements/s");
+    for (int b = 0; b < BATCH_COUNT; ++b)
+    {
+        int count = BATCHES[b];
+        unsigned long vecTime = runVecEnv(count, steps, checksum);
+        unsigned long loopTime = runGames(count, steps, checksum);
+        unsigned long placeTime = runPlacements(count, steps, checksum);
+        double vecRate = 1e6 * count * steps / (vecTime > 0? vecTime : 1);
+        double loopRate = 1e6 * count * steps / (loopTime > 0? loopTime : 1);
+        double placeRate = 1e6 * count * steps / (placeTime > 0? placeTime : 1);
+
+        fprintf(output, "    {\"batch\": %d, \"vecEnvStepsPerSec\": %.0f, \"loopStepsPerSec\": %.0f, "
+                "\"placementStepsPerSec\": %.0f}%s\n",
+                count, vecRate, loopRate, placeRate, (b + 1 < BATCH_COUNT)? "," : "");
+        fprintf(stderr, "%8d %16.0f %16.0f %16.0f\n", count, vecRate, loopRate, placeRate);
+    }
+    fprintf(output, "  ],\n");
+
+    double rates[3];
+    int count = BATCHES[BATCH_COUNT - 1];
+    runObservations(count, steps, checksum, rates);
+    fprintf(output, "  \"observations\": {\"batch\": %d, \"instructionSet\": \"%s\", \"bytesPerSec\": %.0f, "
+            "\"floatsPerSec\": %.0f, \"getCellPerSec\": %.0f},\n",
+            count, stc::ObsEncoder::instructionSet(), rates[0], rates[1], rates[2]);
+    fprintf(stderr, "observations of %d games (%s): bytes %.0f/s, floats %.0f/s, getCell %.0f/s\n",
+            count, stc::ObsEncoder::instructionSet(), rates[0], rates[1], rates[2]);
+    fprintf(output, "  \"checksum\": %ld\n}\n", checksum);
+    if (output != stdout)
+    {
+        fclose(output);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,349 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Game engine micro-benchmarks.                                            */
+/*   Measures ns/op of the hot methods of Game over a corpus of boards taken  */
+/*   from seeded games (played by the AI and by a random player), and writes  */
+/*   the results as JSON. bench_game_nokick is built without wall kick.       */
+/*                                                                            */
+/*   Usage: ./bench_game [results.json]   (JSON goes to stdout by default)    */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "bench_platform.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace stc
+{
+
+// Benchmarks of the engine steps of Game
+class GameBench
+{
+public:
+    // Seeded games used for the corpus, the odd ones use the random player
+    static const int SEED_GAMES = 8;
+    static const int MAX_PIECES = 300;
+
+    // Corpus limits
+    static const int MAX_STATES       = 4096;
+    static const int MAX_CLEAR_STATES = 1024;
+
+    // Minimum time of a measured batch (in microseconds) and batches per result
+    static const unsigned long MIN_BATCH_TIME = 50000;
+    static const int REPEATS = 7;
+
+    // Benchmark body, it runs [rounds] times over the corpus and returns
+    // the number of operations done
+    typedef long (*Body)(int rounds);
+
+    struct Result
+    {
+        const char *name;
+        long   ops;       // operations of a batch
+        double minimum;   // ns/op
+        double median;    // ns/op
+    };
+
+    static void buildCorpus();
+    static Result measure(const char *name, Body body);
+
+    static long checkCollision(int rounds);
+    static long rotateTetromino(int rounds);
+    static long clearRows(int rounds);
+    static long copyState(int rounds);
+    static long shadowGap(int rounds);
+    static long setTetromino(int rounds);
+
+    static std::vector<Game> sStates;      // falling tetromino at every column it fits
+    static std::vector<Game> sClearStates; // the next move down clears rows
+    static Game sWork;
+    static volatile long sSink;
+
+private:
+    static void addStates(const Game &game);
+};
+
+std::vector<Game> GameBench::sStates;
+std::vector<Game> GameBench::sClearStates;
+Game GameBench::sWork;
+volatile long GameBench::sSink = 0;
+
+// Platform of the corpus games while benchmarking
+static BenchPlatform gPlatform(1, false);
+
+// Play the seeded games and keep their boards
+void GameBench::buildCorpus()
+{
+    for (int seed = 1; seed <= SEED_GAMES; ++seed)
+    {
+        BenchPlatform platform((unsigned int)seed, seed % 2 == 0);
+        Game game;
+        game.init(&platform);
+        int pieces = -1;
+        while (!game.isOver() && game.stats().totalPieces < MAX_PIECES)
+        {
+            if (game.stats().totalPieces != pieces)
+            {
+                pieces = game.stats().totalPieces;
+                addStates(game);
+            }
+            game.update();
+        }
+        game.end();
+    }
+    for (size_t i = 0; i < sStates.size(); ++i)
+    {
+        sStates[i].setPlatform(&gPlatform);
+    }
+    for (size_t i = 0; i < sClearStates.size(); ++i)
+    {
+        sClearStates[i].setPlatform(&gPlatform);
+    }
+}
+
+// Add the states of a new falling tetromino: every column where it fits
+// and, for the clear corpus, every landing position that clears rows
+void GameBench::addStates(const Game &game)
+{
+    for (int x = -2; x < Game::BOARD_TILEMAP_WIDTH; ++x)
+    {
+        Game state = game;
+        Game::StcTetromino block = state.fallingBlock();
+        block.x = x;
+        state.setFallingBlock(block);
+        if (state.checkCollision(0, 0))
+        {
+            continue;
+        }
+        if ((int)sStates.size() < MAX_STATES)
+        {
+            sStates.push_back(state);
+        }
+
+        for (int r = 0; r < 4 && (int)sClearStates.size() < MAX_CLEAR_STATES; ++r)
+        {
+            Game landed = state;
+            for (int k = 0; k < r; ++k)
+            {
+                landed.rotateTetromino(true);
+            }
+            int gap = 0;
+            while (!landed.checkCollision(0, gap + 1))
+            {
+                ++gap;
+            }
+            Game::StcTetromino block = landed.fallingBlock();
+            block.y += gap;
+            landed.setFallingBlock(block);
+            Game locked = landed;
+            locked.moveTetromino(0, 1);
+            if (locked.stats().lines > landed.stats().lines)
+            {
+                sClearStates.push_back(landed);
+            }
+        }
+    }
+}
+
+// Run [body] in batches of at least MIN_BATCH_TIME and keep the fastest
+// and the median batch
+GameBench::Result GameBench::measure(const char *name, Body body)
+{
+    Result result;
+    result.name = name;
+
+    // Warm up and find the rounds of a batch
+    int rounds = 1;
+    for (;;)
+    {
+        unsigned long start = FrameProfiler::now();
+        body(rounds);
+        if (FrameProfiler::now() - start >= MIN_BATCH_TIME || rounds >= (1 << 24))
+        {
+            break;
+        }
+        rounds *= 2;
+    }
+
+    std::vector<double> times;
+    for (int i = 0; i < REPEATS; ++i)
+    {
+        unsigned long start = FrameProfiler::now();
+        result.ops = body(rounds);
+        unsigned long elapsed = FrameProfiler::now() - start;
+        times.push_back(1000.0 * elapsed / result.ops);
+    }
+    std::sort(times.begin(), times.end());
+    result.minimum = times[0];
+    result.median = times[REPEATS / 2];
+    return result;
+}
+
+// Collision tests of the three moves
+long GameBench::checkCollision(int rounds)
+{
+    long sink = 0;
+    for (int n = 0; n < rounds; ++n)
+    {
+        for (size_t i = 0; i < sStates.size(); ++i)
+        {
+            Game &state = sStates[i];
+            sink += state.checkCollision(0, 1) + state.checkCollision(-1, 0)
+                    + state.checkCollision(1, 0);
+        }
+    }
+    sSink += sink;
+    return 3L * rounds * (long)sStates.size();
+}
+
+// Clockwise rotations, each one followed by a counterclockwise rotation
+// that turns the tetromino back (a wall kick may leave it moved)
+long GameBench::rotateTetromino(int rounds)
+{
+    long sink = 0;
+    for (int n = 0; n < rounds; ++n)
+    {
+        for (size_t i = 0; i < sStates.size(); ++i)
+        {
+            Game &state = sStates[i];
+            state.rotateTetromino(true);
+            sink += state.fallingBlock().x;
+            state.rotateTetromino(false);
+        }
+    }
+    sSink += sink;
+    return 2L * rounds * (long)sStates.size();
+}
+
+// Moves down that lock the tetromino and clear rows, on a copy of the state
+long GameBench::clearRows(int rounds)
+{
+    for (int n = 0; n < rounds; ++n)
+    {
+        for (size_t i = 0; i < sClearStates.size(); ++i)
+        {
+            sWork = sClearStates[i];
+            sWork.moveTetromino(0, 1);
+        }
+    }
+    sSink += sWork.stats().lines;
+    return (long)rounds * (long)sClearStates.size();
+}
+
+// Copies of the clear states, the cost included in clearRows
+long GameBench::copyState(int rounds)
+{
+    for (int n = 0; n < rounds; ++n)
+    {
+        for (size_t i = 0; i < sClearStates.size(); ++i)
+        {
+            sWork = sClearStates[i];
+        }
+    }
+    sSink += sWork.stats().lines;
+    return (long)rounds * (long)sClearStates.size();
+}
+
+// Shadow gap of the falling tetromino (onTetrominoMoved), set again with
+// setFallingBlock
+long GameBench::shadowGap(int rounds)
+{
+    long sink = 0;
+    for (int n = 0; n < rounds; ++n)
+    {
+        for (size_t i = 0; i < sStates.size(); ++i)
+        {
+            Game &state = sStates[i];
+            state.setFallingBlock(state.fallingBlock());
+#ifdef STC_SHOW_GHOST_PIECE
+            sink += state.shadowGap();
+#endif
+        }
+    }
+    sSink += sink;
+    return (long)rounds * (long)sStates.size();
+}
+
+// Creation of every tetromino type
+long GameBench::setTetromino(int rounds)
+{
+    Game::StcTetromino block;
+    long sink = 0;
+    for (int n = 0; n < rounds; ++n)
+    {
+        for (int type = 0; type < Game::TETROMINO_TYPES; ++type)
+        {
+            Game::setTetromino(type, &block);
+            sink += block.size;
+        }
+    }
+    sSink += sink;
+    return (long)rounds * Game::TETROMINO_TYPES;
+}
+}
+
+using stc::GameBench;
+
+int main(int argc, char **argv)
+{
+    FILE *output = stdout;
+    if (argc > 1 && (output = fopen(argv[1], "w")) == NULL)
+    {
+        fprintf(stderr, "can't write %s\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    GameBench::buildCorpus();
+    if (GameBench::sStates.empty() || GameBench::sClearStates.empty())
+    {
+        fprintf(stderr, "empty corpus\n");
+        return EXIT_FAILURE;
+    }
+
+    GameBench::Result results[6];
+    results[0] = GameBench::measure("checkCollision", GameBench::checkCollision);
+    results[1] = GameBench::measure("rotateTetromino", GameBench::rotateTetromino);
+    results[2] = GameBench::measure("moveTetromino_clearRows", GameBench::clearRows);
+    results[3] = GameBench::measure("copyState", GameBench::copyState);
+    results[4] = GameBench::measure("onTetrominoMoved", GameBench::shadowGap);
+    results[5] = GameBench::measure("setTetromino", GameBench::setTetromino);
+    int count = (int)(sizeof(results) / sizeof(results[0]));
+
+#ifdef STC_WALL_KICK_ENABLED
+    bool wallKick = true;
+#else
+    bool wallKick = false;
+#endif
+#ifdef STC_SHOW_GHOST_PIECE
+    bool shadow = true;
+#else
+    bool shadow = false;
+#endif
+
+    fprintf(output, "{\n  \"benchmark\": \"bench_game\",\n");
+    fprintf(output, "  \"config\": {\"wallKick\": %s, \"shadow\": %s},\n",
+            wallKick? "true" : "false", shadow? "true" : "false");
+    fprintf(output, "  \"corpus\": {\"states\": %d, \"clearStates\": %d},\n",
+            (int)GameBench::sStates.size(), (int)GameBench::sClearStates.size());
+    fprintf(output, "  \"unit\": \"ns/op\",\n  \"results\": [\n");
+    for (int i = 0; i < count; ++i)
+    {
+        fprintf(output, "    {\"name\": \"%s\", \"ops\": %ld, \"min\": %.3f, \"median\": %.3f}%s\n",
+                results[i].name, results[i].ops, results[i].minimum, results[i].median,
+                (i + 1 < count)? "," : "");
+        fprintf(stderr, "%-24s %10.2f ns/op (min %.2f)\n", results[i].name,
+                results[i].median, results[i].minimum);
+    }
+    fprintf(output, "  ]\n}\n");
+    if (output != stdout)
+    {
+        fclose(output);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,49 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Platform for the game engine benchmarks.                                 */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#ifndef STC_BENCH_PLATFORM_HPP_
+#define STC_BENCH_PLATFORM_HPP_
+
+#include "../headless.hpp"
+#include "../ai/ai_player.hpp"
+
+namespace stc
+{
+
+// Headless platform that plays with the AI or random keys
+class BenchPlatform : public PlatformHeadless
+{
+public:
+    BenchPlatform(unsigned int seed, bool useAi) : PlatformHeadless(seed)
+    {
+        mUseAi = useAi;
+    }
+
+    void processEvents()
+    {
+        if (mUseAi)
+        {
+            mPlayer.play(*mGame);
+            return;
+        }
+        static const int KEYS[] = { Game::EVENT_MOVE_LEFT, Game::EVENT_MOVE_RIGHT,
+                                    Game::EVENT_ROTATE_CW, Game::EVENT_DROP };
+        int key = KEYS[random() % 4];
+        mGame->onEventStart(key);
+        mGame->onEventEnd(key);
+    }
+
+private:
+    AiPlayer mPlayer;
+    bool     mUseAi;
+};
+}
+
+#endif // STC_BENCH_PLATFORM_HPP_
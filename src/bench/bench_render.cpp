@@ -0,0 +1,172 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Render path benchmark.                                                   */
+/*   Runs Game::update with PlatformSdl in benchmark mode (no audio, no rest  */
+/*   between frames) on scripted boards of increasing height, and measures    */
+/*   frames/s and blits per frame. Every board is measured moving only the    */
+/*   falling tetromino (damaged regions) and redrawing everything.            */
+/*                                                                            */
+/*   Run it from the bin folder, it uses the dummy video driver unless        */
+/*   SDL_VIDEODRIVER is set:                                                  */
+/*       ./bench_render [frames] [results.json]                               */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "../sdl/sdl_game.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+using stc::Game;
+
+// Put a T tetromino at the top, so the falling never locks it
+static void resetFalling(Game &game)
+{
+    Game::StcTetromino block;
+    Game::setTetromino(Game::TETROMINO_T, &block);
+    block.x = (Game::BOARD_TILEMAP_WIDTH - block.size) / 2;
+    block.y = 0;
+    game.setFallingBlock(block);
+}
+
+// Fill the [rows] bottom rows with one hole per row (so they aren't
+// cleared) and put the falling tetromino back at the top
+static void setBoard(Game &game, int rows)
+{
+    Game::StcMap map;
+    for (int j = 0; j < Game::BOARD_TILEMAP_HEIGHT; ++j)
+    {
+        int hole = (j * 7) % Game::BOARD_TILEMAP_WIDTH;
+        for (int i = 0; i < Game::BOARD_TILEMAP_WIDTH; ++i)
+        {
+            bool filled = (j >= Game::BOARD_TILEMAP_HEIGHT - rows) && (i != hole);
+            map[i][j] = filled? 1 + (i + j) % Game::TETROMINO_TYPES : Game::EMPTY_CELL;
+        }
+    }
+    game.setBoard(map);
+
+    Game::StcTetromino next;
+    Game::setTetromino(Game::TETROMINO_L, &next);
+    game.setNextBlock(next);
+    resetFalling(game);
+}
+
+// Filled rows of the scripted boards
+struct Board
+{
+    const char *name;
+    int rows;
+};
+static const Board BOARDS[] =
+{
+    { "empty", 0 },
+    { "half", Game::BOARD_TILEMAP_HEIGHT / 2 },
+    { "near top-out", Game::BOARD_TILEMAP_HEIGHT - 6 }
+};
+static const int BOARD_COUNT = (int)(sizeof(BOARDS) / sizeof(BOARDS[0]));
+
+// Moves of the falling tetromino, one per frame
+static const int SCRIPT[] =
+{
+    Game::EVENT_MOVE_LEFT, Game::EVENT_MOVE_LEFT, Game::EVENT_ROTATE_CW,
+    Game::EVENT_MOVE_RIGHT, Game::EVENT_MOVE_RIGHT, Game::EVENT_ROTATE_CW
+};
+static const int SCRIPT_LENGTH = (int)(sizeof(SCRIPT) / sizeof(SCRIPT[0]));
+
+// Frames between resets of the falling tetromino, it falls with time
+static const int RESET_FRAMES = 60;
+
+// Frames drawn before measuring
+static const int WARMUP_FRAMES = 50;
+
+// Play [frames] scripted frames, return the elapsed microseconds
+static unsigned long runFrames(Game &game, int frames, bool fullRedraw)
+{
+    unsigned long start = stc::FrameProfiler::now();
+    for (int f = 0; f < frames; ++f)
+    {
+        if (f % RESET_FRAMES == 0)
+        {
+            resetFalling(game);
+        }
+        if (fullRedraw)
+        {
+            game.redrawAll();
+        }
+        int event = SCRIPT[f % SCRIPT_LENGTH];
+        game.onEventStart(event);
+        game.onEventEnd(event);
+        game.update();
+    }
+    return stc::FrameProfiler::now() - start;
+}
+
+int main(int argc, char **argv)
+{
+    int frames = (argc > 1)? atoi(argv[1]) : 5000;
+    FILE *output = stdout;
+    if (frames <= 0)
+    {
+        fprintf(stderr, "usage: %s [frames] [results.json]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (argc > 2 && (output = fopen(argv[2], "w")) == NULL)
+    {
+        fprintf(stderr, "can't write %s\n", argv[2]);
+        return EXIT_FAILURE;
+    }
+    if (getenv("SDL_VIDEODRIVER") == NULL)
+    {
+        putenv((char *)"SDL_VIDEODRIVER=dummy");
+    }
+
+    Game game;
+    stc::PlatformSdl platform;
+    platform.setBenchmark(true);
+    game.init(&platform);
+    if (game.errorCode() != Game::ERROR_NONE)
+    {
+        fprintf(stderr, "can't start the game (error %d), run from the bin folder\n", game.errorCode());
+        return EXIT_FAILURE;
+    }
+
+    fprintf(output, "{\n  \"benchmark\": \"bench_render\",\n  \"frames\": %d,\n  \"results\": [\n", frames);
+    fprintf(stderr, "%-14s %-8s %12s %12s %12s\n", "board", "redraw", "frames/s", "ms/frame", "blits/frame");
+    for (int b = 0; b < BOARD_COUNT; ++b)
+    {
+        for (int mode = 0; mode < 2; ++mode)
+        {
+            bool fullRedraw = (mode == 1);
+            setBoard(game, BOARDS[b].rows);
+            runFrames(game, WARMUP_FRAMES, fullRedraw);
+
+            long blits = platform.blitCount();
+            unsigned long elapsed = runFrames(game, frames, fullRedraw);
+            blits = platform.blitCount() - blits;
+            if (elapsed == 0)
+            {
+                elapsed = 1;
+            }
+            double perSecond = 1e6 * frames / elapsed;
+            double blitsPerFrame = (double)blits / frames;
+
+            fprintf(output, "    {\"board\": \"%s\", \"filledRows\": %d, \"redraw\": \"%s\", "
+                    "\"framesPerSec\": %.1f, \"blitsPerFrame\": %.2f}%s\n", BOARDS[b].name,
+                    BOARDS[b].rows, fullRedraw? "full" : "damaged", perSecond, blitsPerFrame,
+                    (b + 1 < BOARD_COUNT || mode == 0)? "," : "");
+            fprintf(stderr, "%-14s %-8s %12.1f %12.4f %12.2f\n", BOARDS[b].name,
+                    fullRedraw? "full" : "damaged", perSecond, 1000.0 / perSecond, blitsPerFrame);
+        }
+    }
+    fprintf(output, "  ]\n}\n");
+    if (output != stdout)
+    {
+        fclose(output);
+    }
+
+    game.end();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,224 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Software rasterizer benchmark.                                           */
+/*   Draws the same frame with SDL blits (the drawTile/drawNumber path of     */
+/*   PlatformSdl) and with the software rasterizer, checks that both frames   */
+/*   are equal and measures the frame time of each one.                       */
+/*                                                                            */
+/*   Run it from the bin folder, it can run without a display:                */
+/*       SDL_VIDEODRIVER=dummy ./bench_soft [frames]                          */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "../sdl/sdl_game_soft.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+// Same layout as the SDL platform
+static const int SCREEN_WIDTH  = stc::PlatformSdl::SCREEN_WIDTH;
+static const int SCREEN_HEIGHT = stc::PlatformSdl::SCREEN_HEIGHT;
+static const int TILE_SIZE     = stc::PlatformSdl::TILE_SIZE;
+static const int BOARD_X       = stc::PlatformSdl::BOARD_X;
+static const int BOARD_Y       = stc::PlatformSdl::BOARD_Y;
+static const int NUMBER_WIDTH  = stc::PlatformSdl::NUMBER_WIDTH;
+static const int NUMBER_HEIGHT = stc::PlatformSdl::NUMBER_HEIGHT;
+
+// Digits drawn by the eleven statistic counters
+static const int FRAME_DIGITS = stc::PlatformSdl::LEVEL_LENGTH + stc::PlatformSdl::LINES_LENGTH
+                                + stc::PlatformSdl::SCORE_LENGTH + stc::PlatformSdl::PIECES_LENGTH
+                                + stc::Game::TETROMINO_TYPES * stc::PlatformSdl::TETROMINO_LENGTH;
+
+// Frames drawn before measuring
+static const int WARMUP_FRAMES = 50;
+
+// Source position of the tile drawn on a board cell, every other row uses shadow tiles
+static int tileX(int i, int j) { return TILE_SIZE * (1 + (i + j) % stc::Game::TETROMINO_TYPES); }
+static int tileY(int, int j)   { return (TILE_SIZE + 1) * (j % 2); }
+
+// Source and target position of a digit
+static int digitX(int k)   { return NUMBER_WIDTH * (k % 10); }
+static int digitY(int k)   { return NUMBER_HEIGHT * (k % 8); }
+static int digitDstX(int k) { return NUMBER_WIDTH * (k % 25); }
+static int digitDstY(int k) { return NUMBER_HEIGHT * (k / 25); }
+
+// Draw a frame with SDL blits
+static void drawFrameSdl(SDL_Surface *screen, SDL_Surface *back,
+                         SDL_Surface *tiles, SDL_Surface *numbers)
+{
+    SDL_Rect recSource;
+    SDL_Rect recDestine;
+
+    SDL_BlitSurface(back, NULL, screen, NULL);
+
+    recSource.w = TILE_SIZE + 1;
+    recSource.h = TILE_SIZE + 1;
+    for (int i = 0; i < stc::Game::BOARD_TILEMAP_WIDTH; ++i)
+    {
+        for (int j = 0; j < stc::Game::BOARD_TILEMAP_HEIGHT; ++j)
+        {
+            recSource.x = (Sint16)tileX(i, j);
+            recSource.y = (Sint16)tileY(i, j);
+            recDestine.x = (Sint16)(BOARD_X + TILE_SIZE * i);
+            recDestine.y = (Sint16)(BOARD_Y + TILE_SIZE * j);
+            SDL_BlitSurface(tiles, &recSource, screen, &recDestine);
+        }
+    }
+
+    recSource.w = NUMBER_WIDTH;
+    recSource.h = NUMBER_HEIGHT;
+    for (int k = 0; k < FRAME_DIGITS; ++k)
+    {
+        recSource.x = (Sint16)digitX(k);
+        recSource.y = (Sint16)digitY(k);
+        recDestine.x = (Sint16)digitDstX(k);
+        recDestine.y = (Sint16)digitDstY(k);
+        SDL_BlitSurface(numbers, &recSource, screen, &recDestine);
+    }
+}
+
+// Draw a frame with the software rasterizer
+static void drawFrameSoft(const stc::StcImage &frame, const stc::StcImage &back,
+                          const stc::StcImage &tiles, const stc::StcImage &numbers,
+                          uint32_t alphaMask)
+{
+    stc::SoftRaster::copy(frame, 0, 0, back, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+
+    for (int i = 0; i < stc::Game::BOARD_TILEMAP_WIDTH; ++i)
+    {
+        for (int j = 0; j < stc::Game::BOARD_TILEMAP_HEIGHT; ++j)
+        {
+            stc::SoftRaster::copyMasked(frame, BOARD_X + TILE_SIZE * i, BOARD_Y + TILE_SIZE * j,
+                                        tiles, tileX(i, j), tileY(i, j),
+                                        TILE_SIZE + 1, TILE_SIZE + 1, alphaMask);
+        }
+    }
+
+    for (int k = 0; k < FRAME_DIGITS; ++k)
+    {
+        stc::SoftRaster::copyMasked(frame, digitDstX(k), digitDstY(k),
+                                    numbers, digitX(k), digitY(k),
+                                    NUMBER_WIDTH, NUMBER_HEIGHT, alphaMask);
+    }
+}
+
+// FNV-1a hash of the color bits of a frame
+static uint32_t checksum(const stc::StcImage &frame, uint32_t colorMask)
+{
+    uint32_t hash = 2166136261u;
+    for (int j = 0; j < frame.height; ++j)
+    {
+        for (int i = 0; i < frame.width; ++i)
+        {
+            hash = (hash ^ (frame.pixels[j * frame.pitch + i] & colorMask)) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+// Print the time used for drawing a number of frames
+static void report(const char *name, int frames, Uint32 elapsed)
+{
+    if (elapsed == 0)
+    {
+        elapsed = 1;
+    }
+    printf("%-12s %10d %12.4f %12.0f\n", name, frames,
+           (double)elapsed / frames, 1000.0 * frames / elapsed);
+}
+
+int main(int argc, char **argv)
+{
+    int frames = (argc > 1)? atoi(argv[1]) : 2000;
+    if (frames <= 0)
+    {
+        fprintf(stderr, "usage: %s [frames]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    if (SDL_Init(SDL_INIT_VIDEO) < 0)
+    {
+        fprintf(stderr, "SDL_Init: %s\n", SDL_GetError());
+        return EXIT_FAILURE;
+    }
+    SDL_Surface *screen = SDL_SetVideoMode(SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_SWSURFACE);
+    if (screen == NULL || screen->format->BytesPerPixel != 4)
+    {
+        fprintf(stderr, "SDL_SetVideoMode: %s\n", SDL_GetError());
+        SDL_Quit();
+        return EXIT_FAILURE;
+    }
+    Uint32 rmask = screen->format->Rmask;
+    Uint32 gmask = screen->format->Gmask;
+    Uint32 bmask = screen->format->Bmask;
+    Uint32 colorMask = rmask | gmask | bmask;
+
+    // Images for the blit path
+    SDL_Surface *back = stc::PlatformSdl::loadImage(STC_BMP_BACKGROUND, true);
+    SDL_Surface *tiles = stc::PlatformSdl::loadImage(STC_BMP_TILE_BLOCKS, false);
+    SDL_Surface *numbers = stc::PlatformSdl::loadImage(STC_BMP_NUMBERS, false);
+
+    // Images and frame for the software rasterizer
+    SDL_Surface *softBack = stc::PlatformSdlSoft::loadImage32(STC_BMP_BACKGROUND, rmask, gmask, bmask);
+    SDL_Surface *softTiles = stc::PlatformSdlSoft::loadImage32(STC_BMP_TILE_BLOCKS, rmask, gmask, bmask);
+    SDL_Surface *softNumbers = stc::PlatformSdlSoft::loadImage32(STC_BMP_NUMBERS, rmask, gmask, bmask);
+    SDL_Surface *softFrame = SDL_CreateRGBSurface(SDL_SWSURFACE, SCREEN_WIDTH, SCREEN_HEIGHT, 32,
+                                                  rmask, gmask, bmask, ~colorMask);
+
+    if (back == NULL || tiles == NULL || numbers == NULL || softBack == NULL
+            || softTiles == NULL || softNumbers == NULL || softFrame == NULL)
+    {
+        fprintf(stderr, "can't load images, run from the bin folder\n");
+        SDL_Quit();
+        return EXIT_FAILURE;
+    }
+    stc::StcImage frame = stc::PlatformSdlSoft::imageOf(softFrame);
+    stc::StcImage imageBack = stc::PlatformSdlSoft::imageOf(softBack);
+    stc::StcImage imageTiles = stc::PlatformSdlSoft::imageOf(softTiles);
+    stc::StcImage imageNumbers = stc::PlatformSdlSoft::imageOf(softNumbers);
+
+    // Both paths must draw the same frame
+    drawFrameSdl(screen, back, tiles, numbers);
+    drawFrameSoft(frame, imageBack, imageTiles, imageNumbers, ~colorMask);
+    uint32_t hashSdl = checksum(stc::PlatformSdlSoft::imageOf(screen), colorMask);
+    uint32_t hashSoft = checksum(frame, colorMask);
+    printf("rasterizer: %s, checksum: %08x, %s\n", stc::SoftRaster::instructionSet(),
+           (unsigned int)hashSoft, (hashSdl == hashSoft)? "same as SDL" : "DIFFERENT FROM SDL");
+
+    printf("%-12s %10s %12s %12s\n", "path", "frames", "ms/frame", "frames/s");
+
+    for (int f = 0; f < WARMUP_FRAMES; ++f)
+    {
+        drawFrameSdl(screen, back, tiles, numbers);
+    }
+    Uint32 start = SDL_GetTicks();
+    for (int f = 0; f < frames; ++f)
+    {
+        drawFrameSdl(screen, back, tiles, numbers);
+    }
+    report("sdl blits", frames, SDL_GetTicks() - start);
+
+    for (int f = 0; f < WARMUP_FRAMES; ++f)
+    {
+        drawFrameSoft(frame, imageBack, imageTiles, imageNumbers, ~colorMask);
+    }
+    start = SDL_GetTicks();
+    for (int f = 0; f < frames; ++f)
+    {
+        drawFrameSoft(frame, imageBack, imageTiles, imageNumbers, ~colorMask);
+    }
+    report("software", frames, SDL_GetTicks() - start);
+
+    SDL_FreeSurface(back);
+    SDL_FreeSurface(tiles);
+    SDL_FreeSurface(numbers);
+    SDL_FreeSurface(softBack);
+    SDL_FreeSurface(softTiles);
+    SDL_FreeSurface(softNumbers);
+    SDL_FreeSurface(softFrame);
+    SDL_Quit();
+    return (hashSdl == hashSoft)? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,150 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Game throughput benchmark.                                               */
+/*   Plays a fixed set of seeded games to the end with the AI player through  */
+/*   the Game API (events in, update out) and measures games/s, pieces/s and  */
+/*   the latency of Game::update, with 1, 2, 4... threads up to the maximum.  */
+/*   Every thread count plays the same games, so the checksum of the final    */
+/*   scores must be the same for all of them.                                 */
+/*                                                                            */
+/*   Usage: ./bench_throughput [games] [max threads] [results.json]           */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "bench_platform.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+using stc::Game;
+using stc::BenchPlatform;
+using stc::TimeHistogram;
+
+// Games end when the board is full or after this many pieces, the AI
+// could play forever
+static const int MAX_PIECES = 500;
+
+// Work of a thread, it plays the games [first], [first] + [step]...
+struct Worker
+{
+    int  first;
+    int  step;
+    int  games;
+    long pieces;
+    unsigned long checksum;
+    TimeHistogram latency; // Game::update time in nanoseconds
+    pthread_t thread;
+};
+
+// Return the time of the monotonic clock in nanoseconds
+static unsigned long long nowNanos()
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (unsigned long long)time.tv_sec * 1000000000ULL + (unsigned long long)time.tv_nsec;
+}
+
+// Play the games of a worker
+static void *playGames(void *data)
+{
+    Worker *worker = (Worker *)data;
+    worker->pieces = 0;
+    worker->checksum = 0;
+    worker->latency.reset();
+
+    for (int seed = worker->first; seed <= worker->games; seed += worker->step)
+    {
+        BenchPlatform platform((unsigned int)seed, true);
+        Game game;
+        game.init(&platform);
+        while (!game.isOver() && game.stats().totalPieces < MAX_PIECES)
+        {
+            unsigned long long start = nowNanos();
+            game.update();
+            worker->latency.record((unsigned long)(nowNanos() - start));
+        }
+        worker->pieces += game.stats().totalPieces;
+        worker->checksum += (unsigned long)game.stats().score * (unsigned long)seed;
+        game.end();
+    }
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    int games = (argc > 1)? atoi(argv[1]) : 64;
+    int maxThreads = (argc > 2)? atoi(argv[2]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    FILE *output = stdout;
+    if (games <= 0 || maxThreads <= 0)
+    {
+        fprintf(stderr, "usage: %s [games] [max threads] [results.json]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (argc > 3 && (output = fopen(argv[3], "w")) == NULL)
+    {
+        fprintf(stderr, "can't write %s\n", argv[3]);
+        return EXIT_FAILURE;
+    }
+
+    fprintf(output, "{\n  \"benchmark\": \"bench_throughput\",\n");
+    fprintf(output, "  \"games\": %d,\n  \"maxPieces\": %d,\n  \"results\": [\n", games, MAX_PIECES);
+    fprintf(stderr, "%8s %12s %14s %10s %10s %10s %12s\n", "threads", "games/s",
+            "pieces/s", "p50 ns", "p99 ns", "max ns", "checksum");
+
+    std::vector<Worker> workers(maxThreads);
+    for (int threads = 1; ; threads = (threads * 2 < maxThreads)? threads * 2 : maxThreads)
+    {
+        unsigned long long start = nowNanos();
+        for (int t = 0; t < threads; ++t)
+        {
+            workers[t].first = t + 1;
+            workers[t].step = threads;
+            workers[t].games = games;
+            if (pthread_create(&workers[t].thread, NULL, playGames, &workers[t]) != 0)
+            {
+                fprintf(stderr, "can't create thread\n");
+                return EXIT_FAILURE;
+            }
+        }
+
+        long pieces = 0;
+        unsigned long checksum = 0;
+        TimeHistogram latency;
+        for (int t = 0; t < threads; ++t)
+        {
+            pthread_join(workers[t].thread, NULL);
+            pieces += workers[t].pieces;
+            checksum += workers[t].checksum;
+            latency.add(workers[t].latency);
+        }
+        double seconds = (nowNanos() - start) / 1e9;
+
+        fprintf(output, "    {\"threads\": %d, \"seconds\": %.4f, \"gamesPerSec\": %.2f, "
+                "\"piecesPerSec\": %.1f, \"steps\": %lu, \"stepP50Ns\": %lu, \"stepP99Ns\": %lu, "
+                "\"stepMaxNs\": %lu, \"checksum\": %lu}%s\n", threads, seconds, games / seconds,
+                pieces / seconds, latency.count(), latency.percentile(50.0),
+                latency.percentile(99.0), latency.maximum(), checksum,
+                (threads < maxThreads)? "," : "");
+        fprintf(stderr, "%8d %12.2f %14.1f %10lu %10lu %10lu %12lu\n", threads, games / seconds,
+                pieces / seconds, latency.percentile(50.0), latency.percentile(99.0),
+                latency.maximum(), checksum);
+
+        if (threads == maxThreads)
+        {
+            break;
+        }
+    }
+    fprintf(output, "  ]\n}\n");
+    if (output != stdout)
+    {
+        fclose(output);
+    }
+    return EXIT_SUCCESS;
+}
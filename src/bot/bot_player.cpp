@@ -0,0 +1,536 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   External computer player, talks with a bot program through pipes.        */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "bot_player.hpp"
+#include "../ai/ai_player.hpp"
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace stc
+{
+
+// Names of the keys in the replies
+static const struct
+{
+    const char *name;
+    int event;
+}
+KEY_NAMES[] =
+{
+    { "left",   Game::EVENT_MOVE_LEFT },
+    { "right",  Game::EVENT_MOVE_RIGHT },
+    { "down",   Game::EVENT_MOVE_DOWN },
+    { "rotate", Game::EVENT_ROTATE_CW },
+    { "drop",   Game::EVENT_DROP }
+};
+static const int KEY_NAME_COUNT = (int)(sizeof(KEY_NAMES) / sizeof(KEY_NAMES[0]));
+
+// Press and release a key, so there is no autoshift
+static void sendKey(Game &game, int event)
+{
+    game.onEventStart(event);
+    game.onEventEnd(event);
+}
+
+BotPlayer::BotPlayer()
+{
+    mProcess = 0;
+    mToBot = -1;
+    mFromBot = -1;
+    mBlocking = false;
+    mLastId = 0;
+    mStatesSent = 0;
+    mPredictionsUsed = 0;
+    mWaitTime = 0;
+    reset();
+}
+
+BotPlayer::~BotPlayer()
+{
+    stop();
+}
+
+// Run the bot [command] with its standard input and output connected to
+// the game
+bool BotPlayer::start(const char *command)
+{
+    int toBot[2];
+    int fromBot[2];
+    stop();
+    if (pipe(toBot) != 0)
+    {
+        return false;
+    }
+    if (pipe(fromBot) != 0)
+    {
+        close(toBot[0]);
+        close(toBot[1]);
+        return false;
+    }
+
+    mProcess = fork();
+    if (mProcess == 0)
+    {
+        dup2(toBot[0], STDIN_FILENO);
+        dup2(fromBot[1], STDOUT_FILENO);
+        close(toBot[0]);
+        close(toBot[1]);
+        close(fromBot[0]);
+        close(fromBot[1]);
+        execl("/bin/sh", "sh", "-c", command, (char *)NULL);
+        _exit(127);
+    }
+    close(toBot[0]);
+    close(fromBot[1]);
+    if (mProcess < 0)
+    {
+        close(toBot[1]);
+        close(fromBot[0]);
+        mProcess = 0;
+        return false;
+    }
+    mToBot = toBot[1];
+    mFromBot = fromBot[0];
+    fcntl(mFromBot, F_SETFL, fcntl(mFromBot, F_GETFL) | O_NONBLOCK);
+
+    // A bot that exits must not kill the game
+    signal(SIGPIPE, SIG_IGN);
+
+    mInput.clear();
+    reset();
+    return true;
+}
+
+// Ask the bot to exit and wait for it
+void BotPlayer::stop()
+{
+    if (isRunning())
+    {
+        send("quit\n");
+        detach();
+    }
+}
+
+// Close the pipes and wait for the bot
+void BotPlayer::detach()
+{
+    if (!isRunning())
+    {
+        return;
+    }
+    close(mToBot);
+    close(mFromBot);
+    mToBot = -1;
+    mFromBot = -1;
+    waitpid(mProcess, NULL, 0);
+    mProcess = 0;
+}
+
+// Wait for the replies of the bot, call it before init
+void BotPlayer::setBlocking(bool blocking)
+{
+    mBlocking = blocking;
+}
+
+// Forget the current plan
+void BotPlayer::reset()
+{
+    mNewGame = true;
+    mPieces = -1;
+    mPlan.id = 0;
+    mPlan.kind = PLAN_NONE;
+    mNextPlan.id = 0;
+    mNextPlan.kind = PLAN_NONE;
+    mPredictedId = 0;
+    mRotations = 0;
+    mKeyIndex = 0;
+}
+
+// Send the events for the next step of the falling tetromino
+void BotPlayer::play(Game &game)
+{
+    if (!isRunning())
+    {
+        return;
+    }
+    if (game.isOver())
+    {
+        sendKey(game, Game::EVENT_RESTART);
+        reset();
+        return;
+    }
+    if (game.isPaused())
+    {
+        return;
+    }
+
+    readReplies(game, 0);
+    if (game.stats().totalPieces != mPieces)
+    {
+        onNewPiece(game);
+    }
+
+    // Without a plan the tetromino falls, unless the game waits for it
+    if (mBlocking && mPlan.kind == PLAN_NONE)
+    {
+        unsigned long start = FrameProfiler::now();
+        while (isRunning() && mPlan.kind == PLAN_NONE)
+        {
+            if (!readReplies(game, REPLY_TIMEOUT) && isRunning())
+            {
+                // The bot is stuck
+                kill(mProcess, SIGTERM);
+                detach();
+            }
+        }
+        mWaitTime += FrameProfiler::now() - start;
+    }
+    step(game);
+}
+
+// Use the reply to the predicted state if the game is in that state,
+// otherwise send the state
+void BotPlayer::onNewPiece(Game &game)
+{
+    unsigned int rows[Game::BOARD_TILEMAP_HEIGHT];
+    readRows(game, rows);
+    mPieces = game.stats().totalPieces;
+    mRotations = 0;
+    mKeyIndex = 0;
+
+    if (mPredictedId != 0 && mPredictedType == game.fallingBlock().type
+            && memcmp(rows, mPredictedRows, sizeof(rows)) == 0)
+    {
+        ++mPredictionsUsed;
+        mPlan = mNextPlan;
+        mPredictedId = 0;
+        if (mPlan.kind != PLAN_NONE)
+        {
+            onPlan(game);
+        }
+        return;
+    }
+    mPredictedId = 0;
+    mPlan.kind = PLAN_NONE;
+    mPlan.id = sendState(rows, game.fallingBlock(), game.nextBlock().type);
+}
+
+// The bot replied to the state of the falling tetromino
+void BotPlayer::onPlan(Game &game)
+{
+    if (mPlan.kind != PLAN_PLACE)
+    {
+        return;
+    }
+    mTarget = game.fallingBlock();
+    for (int i = 0; i < mPlan.rotations % 4; ++i)
+    {
+        Game::rotateCells(&mTarget, true);
+    }
+    mTarget.x = mPlan.x;
+    predict(game);
+}
+
+// Send the state after the placement of the falling tetromino
+void BotPlayer::predict(Game &game)
+{
+    unsigned int rows[Game::BOARD_TILEMAP_HEIGHT];
+    readRows(game, rows);
+    int x = mTarget.x;
+    int y = game.fallingBlock().y;
+    if (!fits(rows, mTarget, x, y))
+    {
+        return;
+    }
+    while (fits(rows, mTarget, x, y + 1))
+    {
+        ++y;
+    }
+
+    // Lock the tetromino and remove the filled rows, like the game does
+    int i, j;
+    for (i = 0; i < mTarget.size; ++i)
+    {
+        for (j = 0; j < mTarget.size; ++j)
+        {
+            if (mTarget.cells[i][j] != Game::EMPTY_CELL)
+            {
+                rows[y + j] |= 1u << (x + i);
+            }
+        }
+    }
+    const unsigned int filled = (1u << Game::BOARD_TILEMAP_WIDTH) - 1;
+    for (j = 1; j < Game::BOARD_TILEMAP_HEIGHT; ++j)
+    {
+        if (rows[j] == filled)
+        {
+            for (int k = j; k > 0; --k)
+            {
+                rows[k] = rows[k - 1];
+            }
+        }
+    }
+
+    // The next tetromino appears at the top
+    Game::StcTetromino next = game.nextBlock();
+    next.x = (Game::BOARD_TILEMAP_WIDTH - next.size) / 2;
+    next.y = 0;
+    if (!fits(rows, next, next.x, next.y))
+    {
+        return;
+    }
+    mPredictedId = sendState(rows, next, -1);
+    mPredictedType = next.type;
+    memcpy(mPredictedRows, rows, sizeof(rows));
+    mNextPlan.id = mPredictedId;
+    mNextPlan.kind = PLAN_NONE;
+}
+
+// Send the events of the plan for the next step
+void BotPlayer::step(Game &game)
+{
+    if (mPlan.kind == PLAN_PLACE)
+    {
+        // Rotate first, then move to the target column and drop
+        const Game::StcTetromino &block = game.fallingBlock();
+        if (!AiPlayer::sameCells(block, mTarget) && (mRotations < MAX_ROTATIONS))
+        {
+            ++mRotations;
+            sendKey(game, Game::EVENT_ROTATE_CW);
+        }
+        else if (block.x < mTarget.x)
+        {
+            sendKey(game, Game::EVENT_MOVE_RIGHT);
+        }
+        else if (block.x > mTarget.x)
+        {
+            sendKey(game, Game::EVENT_MOVE_LEFT);
+        }
+        else
+        {
+            sendKey(game, Game::EVENT_DROP);
+            mPlan.kind = PLAN_DONE;
+        }
+    }
+    else if (mPlan.kind == PLAN_KEYS && mKeyIndex < mPlan.keyCount)
+    {
+        sendKey(game, mPlan.keys[mKeyIndex++]);
+    }
+}
+
+// Read the available replies, waiting up to [timeout] milliseconds for
+// them. Return false if the bot didn't reply or it exited.
+bool BotPlayer::readReplies(Game &game, int timeout)
+{
+    if (timeout > 0)
+    {
+        struct pollfd input;
+        input.fd = mFromBot;
+        input.events = POLLIN;
+        input.revents = 0;
+        int ready = poll(&input, 1, timeout);
+        if (ready == 0 || (ready < 0 && errno != EINTR))
+        {
+            return false;
+        }
+    }
+
+    char buffer[4096];
+    for (;;)
+    {
+        ssize_t count = read(mFromBot, buffer, sizeof(buffer));
+        if (count > 0)
+        {
+            mInput.append(buffer, count);
+        }
+        else if (count == 0)
+        {
+            detach();
+            return false;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    std::string::size_type start = 0;
+    std::string::size_type end;
+    while ((end = mInput.find('\n', start)) != std::string::npos)
+    {
+        mInput[end] = '\0';
+        parseReply(game, mInput.c_str() + start);
+        start = end + 1;
+    }
+    mInput.erase(0, start);
+    return true;
+}
+
+// Store the plan of a reply, replies to old states are ignored
+void BotPlayer::parseReply(Game &game, const char *line)
+{
+    char command[16];
+    unsigned int id;
+    int length;
+    if (sscanf(line, "%15s %u%n", command, &id, &length) < 2 || id == 0)
+    {
+        return;
+    }
+    StcBotPlan *plan = NULL;
+    if (id == mPlan.id)
+    {
+        plan = &mPlan;
+    }
+    else if (id == mPredictedId)
+    {
+        plan = &mNextPlan;
+    }
+    else
+    {
+        return;
+    }
+    line += length;
+
+    bool isNew = (plan->kind == PLAN_NONE);
+    if (strcmp(command, "place") == 0 && isNew)
+    {
+        if (sscanf(line, "%d %d", &plan->rotations, &plan->x) == 2)
+        {
+            plan->kind = PLAN_PLACE;
+        }
+    }
+    else if (strcmp(command, "keys") == 0 && (isNew || plan->kind == PLAN_KEYS))
+    {
+        if (isNew)
+        {
+            plan->kind = PLAN_KEYS;
+            plan->keyCount = 0;
+        }
+        char key[16];
+        while (sscanf(line, "%15s%n", key, &length) == 1 && plan->keyCount < MAX_KEYS)
+        {
+            line += length;
+            for (int i = 0; i < KEY_NAME_COUNT; ++i)
+            {
+                if (strcmp(key, KEY_NAMES[i].name) == 0)
+                {
+                    plan->keys[plan->keyCount++] = KEY_NAMES[i].event;
+                    break;
+                }
+            }
+        }
+    }
+    if (plan == &mPlan && isNew && plan->kind != PLAN_NONE)
+    {
+        onPlan(game);
+    }
+}
+
+// Send a state and return its id
+unsigned int BotPlayer::sendState(const unsigned int *rows, const Game::StcTetromino &block, int next)
+{
+    char text[64];
+    std::string message;
+    if (mNewGame)
+    {
+        snprintf(text, sizeof(text), "game %d %d\n", Game::BOARD_TILEMAP_WIDTH,
+                 Game::BOARD_TILEMAP_HEIGHT);
+        message = text;
+        mNewGame = false;
+    }
+
+    unsigned int cells = 0;
+    for (int i = 0; i < Game::TETROMINO_SIZE; ++i)
+    {
+        for (int j = 0; j < Game::TETROMINO_SIZE; ++j)
+        {
+            if (block.cells[i][j] != Game::EMPTY_CELL)
+            {
+                cells |= 1u << (i + Game::TETROMINO_SIZE * j);
+            }
+        }
+    }
+    unsigned int id = ++mLastId;
+    snprintf(text, sizeof(text), "state %u %d %d %d %d %d %x", id, block.type,
+             block.size, block.x, block.y, next, cells);
+    message += text;
+    for (int j = 0; j < Game::BOARD_TILEMAP_HEIGHT; ++j)
+    {
+        snprintf(text, sizeof(text), " %x", rows[j]);
+        message += text;
+    }
+    message += '\n';
+    send(message);
+    ++mStatesSent;
+    return id;
+}
+
+// Write a message to the bot, it's closed if it can't be written
+void BotPlayer::send(const std::string &message)
+{
+    const char *data = message.data();
+    size_t left = message.size();
+    while (isRunning() && left > 0)
+    {
+        ssize_t count = write(mToBot, data, left);
+        if (count < 0 && errno != EINTR)
+        {
+            detach();
+        }
+        else if (count > 0)
+        {
+            data += count;
+            left -= count;
+        }
+    }
+}
+
+// Read the locked cells of the board as row bitmasks
+void BotPlayer::readRows(Game &game, unsigned int *rows)
+{
+    for (int j = 0; j < Game::BOARD_TILEMAP_HEIGHT; ++j)
+    {
+        rows[j] = 0;
+        for (int i = 0; i < Game::BOARD_TILEMAP_WIDTH; ++i)
+        {
+            if (game.getCell(i, j) != Game::EMPTY_CELL)
+            {
+                rows[j] |= 1u << i;
+            }
+        }
+    }
+}
+
+// Return true if the tetromino fits on the board at the given position
+bool BotPlayer::fits(const unsigned int *rows, const Game::StcTetromino &block, int x, int y)
+{
+    for (int i = 0; i < block.size; ++i)
+    {
+        for (int j = 0; j < block.size; ++j)
+        {
+            if (block.cells[i][j] != Game::EMPTY_CELL)
+            {
+                if ((x + i < 0) || (x + i >= Game::BOARD_TILEMAP_WIDTH) || (y + j < 0)
+                        || (y + j >= Game::BOARD_TILEMAP_HEIGHT) || (rows[y + j] & (1u << (x + i))))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+}
@@ -0,0 +1,157 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   External computer player, talks with a bot program through pipes with a  */
+/*   line based text protocol. POSIX only.                                    */
+/*                                                                            */
+/*   Messages of the game (one per line, fields separated by spaces):         */
+/*                                                                            */
+/*     game <width> <height>      a new game starts                           */
+/*     state <id> <type> <size> <x> <y> <next> <cells> <row 0>...<row h-1>    */
+/*                                the falling tetromino and the board         */
+/*     quit                       the bot must exit                           */
+/*                                                                            */
+/*   Replies of the bot:                                                      */
+/*                                                                            */
+/*     place <id> <rotations> <x> rotate the tetromino of the state <id>      */
+/*                                clockwise, move it to the column <x> and    */
+/*                                drop it                                     */
+/*     keys <id> <key>...         play these keys, one per game update. The   */
+/*                                keys are left, right, down, rotate, drop.   */
+/*                                                                            */
+/*   <cells> are the cells of the tetromino buffer, bit (x + 4 * y) is set    */
+/*   if the cell (x, y) is filled, and the buffer is at (<x>, <y>). Bit i of  */
+/*   a row is set if the column i is filled, row 0 is the top. Numbers of     */
+/*   cells and rows are in hexadecimal. <next> is the type of the next        */
+/*   tetromino, -1 if it's not known yet.                                     */
+/*                                                                            */
+/*   When the bot places a tetromino the state after that placement is sent   */
+/*   at once, so the bot thinks about the next tetromino while the game       */
+/*   moves the current one. If the game doesn't end in that state (gravity    */
+/*   locked the tetromino elsewhere) the replies to it are ignored and a new  */
+/*   state is sent.                                                           */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#ifndef STC_BOT_PLAYER_HPP_
+#define STC_BOT_PLAYER_HPP_
+
+#include "../game.hpp"
+#include <string>
+#include <sys/types.h>
+
+namespace stc
+{
+
+// Computer player run in another process. It sends the same events as a
+// keyboard player, one step per game update.
+class BotPlayer
+{
+public:
+    // Maximum keys waiting to be played for a tetromino
+    static const int MAX_KEYS = 64;
+
+    // Maximum rotations sent for a placement
+    static const int MAX_ROTATIONS = 3;
+
+    // Time waiting for a reply before giving up (in milliseconds)
+    static const int REPLY_TIMEOUT = 10000;
+
+    BotPlayer();
+    ~BotPlayer();
+
+    // Run the bot [command] with the shell, return false on error
+    bool start(const char *command);
+
+    // Ask the bot to exit and wait for it
+    void stop();
+
+    bool isRunning()    { return mProcess > 0; }
+
+    // Wait for the replies of the bot instead of letting the tetromino fall
+    // while it thinks, used when the game isn't played in real time
+    void setBlocking(bool blocking);
+
+    // Forget the current plan, call it when a new game starts
+    void reset();
+
+    // Send the events for the next step to [game], call it once per update
+    void play(Game &game);
+
+    // Statistics: states sent, predicted states that were used and time
+    // waiting for replies (in microseconds)
+    long statesSent()       { return mStatesSent; }
+    long predictionsUsed()  { return mPredictionsUsed; }
+    unsigned long waitTime() { return mWaitTime; }
+
+private:
+
+    // Kind of plan
+    enum
+    {
+        PLAN_NONE,   // waiting for the bot
+        PLAN_PLACE,  // rotate, move and drop
+        PLAN_KEYS,   // play keys
+        PLAN_DONE    // wait for the next tetromino
+    };
+
+    // Reply of the bot for a state
+    struct StcBotPlan
+    {
+        unsigned int id;
+        int kind;
+        int rotations;
+        int x;
+        int keys[MAX_KEYS];
+        int keyCount;
+    };
+
+    pid_t mProcess;
+    int   mToBot;        // pipe written by the game
+    int   mFromBot;      // pipe read by the game, non blocking
+    std::string mInput;  // start of a reply line
+    bool  mBlocking;
+    bool  mNewGame;      // the game line must be sent
+
+    int   mPieces;       // total pieces when the falling tetromino appeared
+    unsigned int mLastId;
+
+    // Plan for the falling tetromino
+    StcBotPlan mPlan;
+    Game::StcTetromino mTarget;
+    int   mRotations;
+    int   mKeyIndex;
+
+    // State sent for the next tetromino and the reply to it
+    unsigned int mPredictedId;
+    int   mPredictedType;
+    unsigned int mPredictedRows[Game::BOARD_TILEMAP_HEIGHT];
+    StcBotPlan mNextPlan;
+
+    long  mStatesSent;
+    long  mPredictionsUsed;
+    unsigned long mWaitTime;
+
+    void onNewPiece(Game &game);
+    void onPlan(Game &game);
+    void step(Game &game);
+    bool readReplies(Game &game, int timeout);
+    void parseReply(Game &game, const char *line);
+    void predict(Game &game);
+    unsigned int sendState(const unsigned int *rows, const Game::StcTetromino &block, int next);
+    void send(const std::string &message);
+    void detach();
+
+    static void readRows(Game &game, unsigned int *rows);
+    static bool fits(const unsigned int *rows, const Game::StcTetromino &block, int x, int y);
+
+    // Not copyable
+    BotPlayer(const BotPlayer &);
+    BotPlayer &operator=(const BotPlayer &);
+};
+}
+
+#endif // STC_BOT_PLAYER_HPP_
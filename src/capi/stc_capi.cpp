@@ -0,0 +1,216 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   C interface of the game engine, over VecEnv.                             */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "stc_capi.h"
+#include "../env/vec_env.hpp"
+#include <cstring>
+#include <new>
+
+using stc::Game;
+using stc::VecEnv;
+
+// The constants of the interface are the ones of the engine, the build
+// fails here if they differ
+typedef char StcCheckWidth[(STC_BOARD_WIDTH == VecEnv::WIDTH)? 1 : -1];
+typedef char StcCheckHeight[(STC_BOARD_HEIGHT == VecEnv::HEIGHT)? 1 : -1];
+typedef char StcCheckBoard[(STC_BOARD_SIZE == VecEnv::BOARD_SIZE)? 1 : -1];
+typedef char StcCheckPlacements[(STC_PLACEMENT_COUNT == Game::PLACEMENT_COUNT)? 1 : -1];
+typedef char StcCheckActions[(STC_ACTION_COUNT == (int)VecEnv::ACTION_COUNT)? 1 : -1];
+typedef char StcCheckPlacementSpace[(STC_ACTIONS_PLACEMENT == (int)VecEnv::ACTIONS_PLACEMENT)? 1 : -1];
+typedef char StcCheckInt[(sizeof(int32_t) == sizeof(int))? 1 : -1];
+
+struct StcEnv
+{
+    explicit StcEnv(int count) : env(count)
+    {
+        memset(&buffers, 0, sizeof(buffers));
+    }
+
+    VecEnv             env;
+    stc::StcEnvBuffers buffers;
+};
+
+struct StcSnapshot
+{
+    stc::StcEnvState state;
+};
+
+// Return true if the buffers written by the steps were set
+static bool hasBuffers(const StcEnv *env)
+{
+    return env->buffers.board != NULL;
+}
+
+int stcVersion(void)
+{
+    return STC_API_VERSION;
+}
+
+StcEnv *stcCreate(int count)
+{
+    if (count <= 0)
+    {
+        return NULL;
+    }
+
+    // No exception may leave the interface, the games are kept in vectors
+    try
+    {
+        return new StcEnv(count);
+    }
+    catch (const std::bad_alloc &)
+    {
+        return NULL;
+    }
+}
+
+void stcDestroy(StcEnv *env)
+{
+    delete env;
+}
+
+int stcCount(const StcEnv *env)
+{
+    return (env != NULL)? env->env.count() : STC_ERROR_ARGUMENT;
+}
+
+int stcSetActionSpace(StcEnv *env, int space)
+{
+    if (env == NULL || (space != STC_ACTIONS_KEYS && space != STC_ACTIONS_PLACEMENT))
+    {
+        return STC_ERROR_ARGUMENT;
+    }
+    env->env.setActionSpace(space);
+    return STC_OK;
+}
+
+int stcSetBuffers(StcEnv *env, uint8_t *board, int32_t *pieces,
+                  float *rewards, uint8_t *dones, uint8_t *masks)
+{
+    if (env == NULL || board == NULL || pieces == NULL || rewards == NULL || dones == NULL)
+    {
+        return STC_ERROR_ARGUMENT;
+    }
+    stc::StcEnvBuffers buffers = { board, pieces, rewards, dones, masks };
+    env->buffers = buffers;
+    env->env.setBuffers(buffers);
+    return STC_OK;
+}
+
+int stcReset(StcEnv *env, const uint32_t *seeds)
+{
+    if (env == NULL || seeds == NULL)
+    {
+        return STC_ERROR_ARGUMENT;
+    }
+    if (!hasBuffers(env))
+    {
+        return STC_ERROR_BUFFERS;
+    }
+    env->env.reset(seeds);
+    return STC_OK;
+}
+
+int stcStep(StcEnv *env, const int32_t *actions)
+{
+    if (env == NULL || actions == NULL)
+    {
+        return STC_ERROR_ARGUMENT;
+    }
+    if (!hasBuffers(env))
+    {
+        return STC_ERROR_BUFFERS;
+    }
+    env->env.step(actions);
+    return STC_OK;
+}
+
+int stcStepMany(StcEnv *env, int steps, const int32_t *actions,
+                float *rewards, uint8_t *dones)
+{
+    if (env == NULL || steps < 0 || (actions == NULL && steps > 0))
+    {
+        return STC_ERROR_ARGUMENT;
+    }
+    if (!hasBuffers(env))
+    {
+        return STC_ERROR_BUFFERS;
+    }
+    int count = env->env.count();
+    for (int s = 0; s < steps; ++s)
+    {
+        env->env.step(actions + s * count);
+        if (rewards != NULL)
+        {
+            memcpy(rewards + s * count, env->buffers.rewards, count * sizeof(float));
+        }
+        if (dones != NULL)
+        {
+            memcpy(dones + s * count, env->buffers.dones, count);
+        }
+    }
+    return STC_OK;
+}
+
+int stcStats(StcEnv *env, int index, StcGameStats *stats)
+{
+    if (env == NULL || stats == NULL)
+    {
+        return STC_ERROR_ARGUMENT;
+    }
+    if (index < 0 || index >= env->env.count())
+    {
+        return STC_ERROR_INDEX;
+    }
+    Game &game = env->env.game(index);
+    stats->score = game.stats().score;
+    stats->lines = game.stats().lines;
+    stats->level = game.stats().level;
+    stats->pieces = game.stats().totalPieces;
+    stats->isOver = game.isOver()? 1 : 0;
+    return STC_OK;
+}
+
+StcSnapshot *stcSnapshot(StcEnv *env, int index)
+{
+    if (env == NULL || index < 0 || index >= env->env.count())
+    {
+        return NULL;
+    }
+    StcSnapshot *snapshot = new (std::nothrow) StcSnapshot;
+    if (snapshot != NULL)
+    {
+        env->env.save(index, snapshot->state);
+    }
+    return snapshot;
+}
+
+int stcRestore(StcEnv *env, int index, const StcSnapshot *snapshot)
+{
+    if (env == NULL || snapshot == NULL)
+    {
+        return STC_ERROR_ARGUMENT;
+    }
+    if (index < 0 || index >= env->env.count())
+    {
+        return STC_ERROR_INDEX;
+    }
+    if (!hasBuffers(env))
+    {
+        return STC_ERROR_BUFFERS;
+    }
+    env->env.restore(index, snapshot->state);
+    return STC_OK;
+}
+
+void stcSnapshotDestroy(StcSnapshot *snapshot)
+{
+    delete snapshot;
+}
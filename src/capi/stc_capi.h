@@ -0,0 +1,136 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   C interface of the game engine, built as libstc.so (make libstc).        */
+/*   It runs batches of seeded games without screen, sound or platform and    */
+/*   writes their observations in buffers owned by the caller, so bindings    */
+/*   (ctypes, cffi) can pass the memory of their arrays directly.             */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#ifndef STC_CAPI_STC_CAPI_H_
+#define STC_CAPI_STC_CAPI_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef _WIN32
+#define STC_API __declspec(dllexport)
+#else
+#define STC_API __attribute__((visibility("default")))
+#endif
+
+/* Version of this interface, changed when a function or a layout changes */
+enum { STC_API_VERSION = 2 };
+
+/* Board size (in tiles) */
+enum { STC_BOARD_WIDTH  = 10 };
+enum { STC_BOARD_HEIGHT = 22 };
+
+/* Board planes of the observations: the locked cells and the cells of the
+ * falling tetromino, each one STC_BOARD_HEIGHT rows of STC_BOARD_WIDTH bytes */
+enum { STC_PLANES = 2 };
+enum { STC_BOARD_SIZE = STC_PLANES * STC_BOARD_HEIGHT * STC_BOARD_WIDTH };
+
+/* Placements, rotations * STC_BOARD_WIDTH + column of the leftmost cell */
+enum { STC_PLACEMENT_COUNT = 4 * STC_BOARD_WIDTH };
+
+/* Action spaces */
+enum
+{
+    STC_ACTIONS_KEYS,       /* a key pressed during a frame per step */
+    STC_ACTIONS_PLACEMENT   /* a placement (and a whole tetromino) per step */
+};
+
+/* Actions of STC_ACTIONS_KEYS */
+enum
+{
+    STC_ACTION_NONE,
+    STC_ACTION_LEFT,
+    STC_ACTION_RIGHT,
+    STC_ACTION_DOWN,
+    STC_ACTION_ROTATE,
+    STC_ACTION_DROP,
+    STC_ACTION_COUNT
+};
+
+/* Error codes */
+enum
+{
+    STC_OK             = 0,
+    STC_ERROR_INDEX    = -1,    /* no game with that index */
+    STC_ERROR_ARGUMENT = -2,    /* NULL pointer or value out of range */
+    STC_ERROR_BUFFERS  = -3     /* stcSetBuffers wasn't called */
+};
+
+/* Statistics of a game */
+typedef struct StcGameStats
+{
+    int64_t score;
+    int32_t lines;
+    int32_t level;
+    int32_t pieces;
+    int32_t isOver;
+} StcGameStats;
+
+/* Batch of games and saved game, both opaque */
+typedef struct StcEnv StcEnv;
+typedef struct StcSnapshot StcSnapshot;
+
+STC_API int stcVersion(void);
+
+/* Create a batch of [count] games, NULL if [count] isn't positive or there
+ * isn't memory. Call stcSetBuffers and stcReset before stepping it.
+ * Functions returning int give STC_OK or an error code, except stcVersion
+ * and stcCount (STC_ERROR_ARGUMENT for a NULL batch). */
+STC_API StcEnv *stcCreate(int count);
+STC_API void stcDestroy(StcEnv *env);
+STC_API int stcCount(const StcEnv *env);
+
+/* Set STC_ACTIONS_KEYS (the default) or STC_ACTIONS_PLACEMENT */
+STC_API int stcSetActionSpace(StcEnv *env, int space);
+
+/* Set the buffers written by stcReset and stcStep, one entry per game:
+ *   board   [count][STC_BOARD_SIZE], 1 if the cell is filled
+ *   pieces  [count][2], types of the falling and next tetrominoes
+ *   rewards [count], score gained in the step
+ *   dones   [count], 1 if the game ended in the step (it starts again)
+ *   masks   [count][STC_PLACEMENT_COUNT], legal placements, only written
+ *           with STC_ACTIONS_PLACEMENT (may be NULL)
+ * Only masks may be NULL. The buffers must live until they are replaced or
+ * the batch destroyed. */
+STC_API int stcSetBuffers(StcEnv *env, uint8_t *board, int32_t *pieces,
+                          float *rewards, uint8_t *dones, uint8_t *masks);
+
+/* Start new games seeded with [seeds] (one per game) */
+STC_API int stcReset(StcEnv *env, const uint32_t *seeds);
+
+/* Step every game with [actions] (one per game) */
+STC_API int stcStep(StcEnv *env, const int32_t *actions);
+
+/* Step every game [steps] times with [actions] ([steps][count]). The
+ * buffers hold the results of the last step, [rewards] and [dones] (may be
+ * NULL) get the results of every step ([steps][count] each). */
+STC_API int stcStepMany(StcEnv *env, int steps, const int32_t *actions,
+                        float *rewards, uint8_t *dones);
+
+STC_API int stcStats(StcEnv *env, int index, StcGameStats *stats);
+
+/* Save a game (NULL if the index is wrong or there isn't memory) and
+ * restore it in any game of any batch, restoring writes its observation
+ * in the buffers */
+STC_API StcSnapshot *stcSnapshot(StcEnv *env, int index);
+STC_API int stcRestore(StcEnv *env, int index, const StcSnapshot *snapshot);
+STC_API void stcSnapshotDestroy(StcSnapshot *snapshot);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STC_CAPI_STC_CAPI_H_ */
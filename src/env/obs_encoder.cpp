@@ -0,0 +1,178 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Observation encoder.                                                     */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "obs_encoder.hpp"
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace stc
+{
+
+#if defined(__AVX2__)
+
+// Rows of the planes of a board, one after the other
+static const int BOARD_ROWS = ObsEncoder::PLANES * ObsEncoder::HEIGHT;
+
+// Every row is written with two stores of 8 cells, columns 0 to 7 and 2 to
+// 9, so the writes never go past the row
+typedef char StcCheckRowWidth[(ObsEncoder::WIDTH > 8 && ObsEncoder::WIDTH <= 16)? 1 : -1];
+static const int TAIL = ObsEncoder::WIDTH - 8;
+
+#else
+
+// Write the cells of a packed board, a row at a time
+template <typename T>
+static inline void expandRows(const StcPackedObs &packed, T *board)
+{
+    for (int p = 0; p < ObsEncoder::PLANES; ++p)
+    {
+        for (int j = 0; j < ObsEncoder::HEIGHT; ++j)
+        {
+            unsigned int row = packed.rows[p][j];
+            for (int i = 0; i < ObsEncoder::WIDTH; ++i)
+            {
+                *board++ = (T)((row >> i) & 1);
+            }
+        }
+    }
+}
+
+#endif
+
+// Pack the board and the tetrominoes of a game
+void ObsEncoder::encode(const Game &game, StcPackedObs &packed)
+{
+    memset(packed.rows[PLANE_FALLING], 0, sizeof(packed.rows[PLANE_FALLING]));
+
+#if defined(__AVX2__)
+    // The map is stored by columns, so 8 rows of a column are compared at
+    // once and their bits added to 8 rows. The last group overlaps the
+    // previous one to stay inside the columns.
+    const Game::StcMap &map = game.map();
+    const __m256i empty = _mm256_set1_epi32(Game::EMPTY_CELL);
+    for (int j = 0; j < HEIGHT; j += 8)
+    {
+        int top = (j + 8 <= HEIGHT)? j : HEIGHT - 8;
+        __m256i rows = _mm256_setzero_si256();
+        for (int i = 0; i < WIDTH; ++i)
+        {
+            __m256i cells = _mm256_loadu_si256((const __m256i *)&map[i][top]);
+            __m256i isEmpty = _mm256_cmpeq_epi32(cells, empty);
+            rows = _mm256_or_si256(rows, _mm256_andnot_si256(isEmpty, _mm256_set1_epi32(1 << i)));
+        }
+        __m128i rows16 = _mm_packus_epi32(_mm256_castsi256_si128(rows), _mm256_extracti128_si256(rows, 1));
+        _mm_storeu_si128((__m128i *)&packed.rows[PLANE_LOCKED][top], rows16);
+    }
+#else
+    // The map is stored by columns, a row is built in a register
+    const Game::StcMap &map = game.map();
+    for (int j = 0; j < HEIGHT; ++j)
+    {
+        unsigned int row = 0;
+        for (int i = 0; i < WIDTH; ++i)
+        {
+            row |= (unsigned int)(map[i][j] != Game::EMPTY_CELL) << i;
+        }
+        packed.rows[PLANE_LOCKED][j] = (uint16_t)row;
+    }
+#endif
+
+    const Game::StcTetromino &block = game.fallingBlock();
+    for (int i = 0; i < block.size; ++i)
+    {
+        for (int j = 0; j < block.size; ++j)
+        {
+            int x = block.x + i;
+            int y = block.y + j;
+            if (block.cells[i][j] != Game::EMPTY_CELL && x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT)
+            {
+                packed.rows[PLANE_FALLING][y] |= (uint16_t)(1 << x);
+            }
+        }
+    }
+
+    packed.type = (int8_t)block.type;
+    packed.next = (int8_t)game.nextBlock().type;
+    packed.x = (int8_t)block.x;
+    packed.y = (int8_t)block.y;
+}
+
+// Expand packed boards to bytes
+void ObsEncoder::expand(const StcPackedObs *packed, int count, uint8_t *planes)
+{
+#if defined(__AVX2__)
+    // The two bytes of a row are copied to 8 bytes each, every byte keeps
+    // a bit and compares it
+    const __m128i spread = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1);
+    const __m128i bit = _mm_set1_epi64x((long long)0x8040201008040201ULL);
+    const __m128i one = _mm_set1_epi8(1);
+    for (int b = 0; b < count; ++b)
+    {
+        const uint16_t *rows = &packed[b].rows[0][0];
+        uint8_t *cells = planes + b * BOARD_SIZE;
+        for (int r = 0; r < BOARD_ROWS; ++r, cells += WIDTH)
+        {
+            __m128i v = _mm_shuffle_epi8(_mm_set1_epi16((short)rows[r]), spread);
+            v = _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(v, bit), bit), one);
+            _mm_storel_epi64((__m128i *)cells, v);
+            _mm_storel_epi64((__m128i *)(cells + TAIL), _mm_srli_si128(v, TAIL));
+        }
+    }
+#else
+    for (int b = 0; b < count; ++b)
+    {
+        expandRows(packed[b], planes + b * BOARD_SIZE);
+    }
+#endif
+}
+
+// Expand packed boards to floats
+void ObsEncoder::expand(const StcPackedObs *packed, int count, float *planes)
+{
+#if defined(__AVX2__)
+    // A row is copied to 8 lanes, every lane keeps a bit and compares it,
+    // the comparison masks 1.0
+    const __m256i bit = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    for (int b = 0; b < count; ++b)
+    {
+        const uint16_t *rows = &packed[b].rows[0][0];
+        float *cells = planes + b * BOARD_SIZE;
+        for (int r = 0; r < BOARD_ROWS; ++r, cells += WIDTH)
+        {
+            __m256i head = _mm256_set1_epi32(rows[r]);
+            __m256i tail = _mm256_set1_epi32(rows[r] >> TAIL);
+            head = _mm256_cmpeq_epi32(_mm256_and_si256(head, bit), bit);
+            tail = _mm256_cmpeq_epi32(_mm256_and_si256(tail, bit), bit);
+            _mm256_storeu_ps(cells, _mm256_and_ps(_mm256_castsi256_ps(head), one));
+            _mm256_storeu_ps(cells + TAIL, _mm256_and_ps(_mm256_castsi256_ps(tail), one));
+        }
+    }
+#else
+    for (int b = 0; b < count; ++b)
+    {
+        expandRows(packed[b], planes + b * BOARD_SIZE);
+    }
+#endif
+}
+
+// Name of the instruction set used for expanding
+const char *ObsEncoder::instructionSet()
+{
+#if defined(__AVX2__)
+    return "avx2";
+#else
+    return "scalar";
+#endif
+}
+}
@@ -0,0 +1,65 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Observation encoder: packs the board of a game in a bit per cell, with   */
+/*   the falling and next tetrominoes, and expands batches of packed boards   */
+/*   to planes of bytes or floats. The expansion uses AVX2 when the compiler  */
+/*   targets it (for example with -mavx2), otherwise plain C++ is used.       */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#ifndef STC_ENV_OBS_ENCODER_HPP_
+#define STC_ENV_OBS_ENCODER_HPP_
+
+#include "../game.hpp"
+#include <stdint.h>
+
+namespace stc
+{
+
+struct StcPackedObs;
+
+class ObsEncoder
+{
+public:
+    // Board planes
+    enum
+    {
+        PLANE_LOCKED,   // cells of the board
+        PLANE_FALLING,  // cells of the falling tetromino
+        PLANES
+    };
+
+    static const int WIDTH  = Game::BOARD_TILEMAP_WIDTH;
+    static const int HEIGHT = Game::BOARD_TILEMAP_HEIGHT;
+
+    // Cells of the planes of a board
+    static const int BOARD_SIZE = PLANES * HEIGHT * WIDTH;
+
+    // Pack the board and the tetrominoes of [game]
+    static void encode(const Game &game, StcPackedObs &packed);
+
+    // Expand [count] packed boards to [planes] ([count][PLANES][HEIGHT][WIDTH]),
+    // 1 for the filled cells and 0 for the others
+    static void expand(const StcPackedObs *packed, int count, uint8_t *planes);
+    static void expand(const StcPackedObs *packed, int count, float *planes);
+
+    // Name of the instruction set used for expanding
+    static const char *instructionSet();
+};
+
+// Packed observation of a game
+struct StcPackedObs
+{
+    uint16_t rows[ObsEncoder::PLANES][ObsEncoder::HEIGHT];  // bit i is column i
+    int8_t   type;  // falling tetromino
+    int8_t   next;  // next tetromino
+    int8_t   x;     // position of the falling tetromino
+    int8_t   y;
+};
+}
+
+#endif // STC_ENV_OBS_ENCODER_HPP_
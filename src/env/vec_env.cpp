@@ -0,0 +1,131 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Vectorized environment for reinforcement learning.                       */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "vec_env.hpp"
+#include <cstring>
+
+namespace stc
+{
+
+// Game event of every action
+static const int ACTION_EVENTS[VecEnv::ACTION_COUNT] =
+{
+    Game::EVENT_NONE,
+    Game::EVENT_MOVE_LEFT,
+    Game::EVENT_MOVE_RIGHT,
+    Game::EVENT_MOVE_DOWN,
+    Game::EVENT_ROTATE_CW,
+    Game::EVENT_DROP
+};
+
+VecEnv::VecEnv(int count) : mGames(count), mPlatforms(count), mScores(count, 0), mPacked(count)
+{
+    memset(&mBuffers, 0, sizeof(mBuffers));
+    mActionSpace = ACTIONS_KEYS;
+}
+
+// Set the buffers written by reset and step
+void VecEnv::setBuffers(const StcEnvBuffers &buffers)
+{
+    mBuffers = buffers;
+}
+
+// Start new games seeded with [seeds]
+void VecEnv::reset(const unsigned int *seeds)
+{
+    for (int i = 0; i < count(); ++i)
+    {
+        mPlatforms[i].seed(seeds[i]);
+        mGames[i].init(&mPlatforms[i]);
+        mScores[i] = 0;
+        mBuffers.rewards[i] = 0.0f;
+        mBuffers.dones[i] = 0;
+        observe(i);
+    }
+    ObsEncoder::expand(&mPacked[0], count(), mBuffers.board);
+}
+
+// Play a frame of every game
+void VecEnv::step(const int *actions)
+{
+    for (int i = 0; i < count(); ++i)
+    {
+        Game &game = mGames[i];
+        int action = actions[i];
+        if (mActionSpace == ACTIONS_PLACEMENT)
+        {
+            if (!game.place(action))
+            {
+                game.onEventStart(Game::EVENT_DROP);
+                game.onEventEnd(Game::EVENT_DROP);
+                game.update();
+            }
+        }
+        else
+        {
+            if (action > ACTION_NONE && action < ACTION_COUNT)
+            {
+                // Press and release the key, so there is no autoshift
+                game.onEventStart(ACTION_EVENTS[action]);
+                game.onEventEnd(ACTION_EVENTS[action]);
+            }
+            game.update();
+        }
+
+        long score = game.stats().score;
+        mBuffers.rewards[i] = (float)(score - mScores[i]);
+        mScores[i] = score;
+        mBuffers.dones[i] = game.isOver()? 1 : 0;
+        if (game.isOver())
+        {
+            game.init(&mPlatforms[i]);
+            mScores[i] = 0;
+        }
+        observe(i);
+    }
+    ObsEncoder::expand(&mPacked[0], count(), mBuffers.board);
+}
+
+// Save a game
+void VecEnv::save(int index, StcEnvState &state) const
+{
+    state.game = mGames[index];
+    state.platform = mPlatforms[index];
+    state.score = mScores[index];
+}
+
+// Restore a saved game, the copies point to the platform and game of the index
+void VecEnv::restore(int index, const StcEnvState &state)
+{
+    mGames[index] = state.game;
+    mPlatforms[index] = state.platform;
+    mPlatforms[index].init(&mGames[index]);
+    mGames[index].setPlatform(&mPlatforms[index]);
+    mScores[index] = state.score;
+    observe(index);
+    ObsEncoder::expand(&mPacked[index], 1, mBuffers.board + index * BOARD_SIZE);
+}
+
+// Pack the board of a game and write its tetromino types, the board is
+// expanded with the others by the caller
+void VecEnv::observe(int index)
+{
+    Game &game = mGames[index];
+    StcPackedObs &packed = mPacked[index];
+    ObsEncoder::encode(game, packed);
+    mBuffers.pieces[2 * index] = packed.type;
+    mBuffers.pieces[2 * index + 1] = packed.next;
+
+    if (mActionSpace == ACTIONS_PLACEMENT && mBuffers.masks != NULL)
+    {
+        game.findPlacements(mBuffers.masks + index * Game::PLACEMENT_COUNT);
+    }
+}
+}
@@ -0,0 +1,131 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Vectorized environment for reinforcement learning: steps a batch of      */
+/*   games in lockstep and writes their observations, rewards and done flags  */
+/*   in buffers owned by the caller.                                          */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#ifndef STC_ENV_VEC_ENV_HPP_
+#define STC_ENV_VEC_ENV_HPP_
+
+#include "obs_encoder.hpp"
+#include "../headless.hpp"
+#include <stdint.h>
+#include <vector>
+
+namespace stc
+{
+
+// Output buffers of a VecEnv, owned by the caller. Every step writes one
+// entry per game (in the order of the games) and nothing else.
+struct StcEnvBuffers
+{
+    uint8_t *board;    // [count][PLANES][height][width], 1 if the cell is filled
+    int32_t *pieces;   // [count][2], types of the falling and next tetrominoes
+    float   *rewards;  // [count], score gained in the step
+    uint8_t *dones;    // [count], 1 if the game ended in the step
+    uint8_t *masks;    // [count][PLACEMENT_COUNT], legal placements, only
+                       // written with ACTIONS_PLACEMENT (may be NULL)
+};
+
+// Saved game of a VecEnv, with its random numbers and score
+struct StcEnvState
+{
+    Game             game;
+    PlatformHeadless platform;
+    long             score;
+};
+
+// Batch of games stepped together. Every step plays one frame of every
+// game with one action each, or with ACTIONS_PLACEMENT drops a whole
+// tetromino. A game that ends is started again at once (its random numbers
+// continue from its seed), the step reports it as done and writes the
+// observation of the new game.
+class VecEnv
+{
+public:
+    // Actions, a key pressed and released during the frame
+    enum
+    {
+        ACTION_NONE,
+        ACTION_LEFT,
+        ACTION_RIGHT,
+        ACTION_DOWN,
+        ACTION_ROTATE,
+        ACTION_DROP,
+        ACTION_COUNT
+    };
+
+    // Action spaces
+    enum
+    {
+        ACTIONS_KEYS,       // ACTION_NONE to ACTION_DROP, a frame per step
+        ACTIONS_PLACEMENT   // Game placements, a tetromino per step
+    };
+
+    // Board planes of the observations
+    enum
+    {
+        PLANE_LOCKED  = ObsEncoder::PLANE_LOCKED,
+        PLANE_FALLING = ObsEncoder::PLANE_FALLING,
+        PLANES        = ObsEncoder::PLANES
+    };
+
+    static const int WIDTH  = ObsEncoder::WIDTH;
+    static const int HEIGHT = ObsEncoder::HEIGHT;
+
+    // Bytes of the board observation of a game
+    static const int BOARD_SIZE = ObsEncoder::BOARD_SIZE;
+
+    explicit VecEnv(int count);
+
+    int count() const   { return (int)mGames.size(); }
+
+    // Set the buffers written by reset and step
+    void setBuffers(const StcEnvBuffers &buffers);
+
+    // Set the action space, ACTIONS_KEYS by default. With ACTIONS_PLACEMENT
+    // an action is a placement (see Game::place), an illegal one drops the
+    // tetromino where it is, and the legal ones are written in the masks.
+    void setActionSpace(int space)  { mActionSpace = space; }
+
+    // Start new games seeded with [seeds] (one per game) and write their
+    // observations, the rewards and done flags are cleared
+    void reset(const unsigned int *seeds);
+
+    // Play a step of every game with [actions] (one per game, invalid key
+    // actions are ACTION_NONE) and write the results
+    void step(const int *actions);
+
+    Game &game(int index)   { return mGames[index]; }
+
+    // Packed observation of a game, the board buffer holds it expanded
+    const StcPackedObs &packed(int index) const { return mPacked[index]; }
+
+    // Save a game, restore writes its observation (not the reward or done)
+    void save(int index, StcEnvState &state) const;
+    void restore(int index, const StcEnvState &state);
+
+private:
+
+    std::vector<Game>        mGames;
+    std::vector<PlatformHeadless> mPlatforms;
+    std::vector<long>        mScores;   // score after the last step
+    std::vector<StcPackedObs> mPacked;  // observations, expanded every step
+    StcEnvBuffers mBuffers;
+    int           mActionSpace;
+
+    void observe(int index);
+
+    // Not copyable, the games point to the platforms
+    VecEnv(const VecEnv &);
+    VecEnv &operator=(const VecEnv &);
+};
+}
+
+#endif // STC_ENV_VEC_ENV_HPP_
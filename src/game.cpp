@@ -10,6 +10,7 @@
 
 #include "game.hpp"
 #include <stdlib.h>
+#include <string.h>
 
 namespace stc
 {
@@ -126,6 +127,10 @@ void Game::start()
     // Initialize events
     onTetrominoMoved();
 
+    // Everything must be processed again
+    onChangeProcessed();
+    mChanges.flags = CHANGE_ALL;
+
     // Initialize delayed autoshift
     mDelayLeft = -1;
     mDelayRight = -1;
@@ -135,6 +140,12 @@ void Game::start()
 #endif
 }
 
+Game::Game()
+{
+    mPlatform = NULL;
+    mProfiler = NULL;
+}
+
 // Initialize the game. The error code (if any) is saved in [mErrorcode].
 void Game::init(Platform *targetPlatform)
 {
@@ -157,37 +168,44 @@ void Game::end()
     mPlatform->end();
 }
 
-// Rotate falling tetromino. If there are no collisions when the
-// tetromino is rotated this modifies the tetromino's cell buffer.
-void Game::rotateTetromino(bool clockwise)
+// Rotate the cells of a tetromino in its buffer, its position doesn't change
+void Game::rotateCells(StcTetromino *tetromino, bool clockwise)
 {
-    int i, j;
-    int rotated[TETROMINO_SIZE][TETROMINO_SIZE];  // temporary array to hold rotated cells
-
-    // If TETROMINO_O is falling return immediately
-    if (mFallingBlock.type == TETROMINO_O)
-    {
-        return; // rotation doesn't require any changes
-    }
-
-    // Initialize rotated cells to blank
+    int rotated[TETROMINO_SIZE][TETROMINO_SIZE];
     setMatrixCells(&rotated[0][0], TETROMINO_SIZE, TETROMINO_SIZE, EMPTY_CELL);
-
-    // Copy rotated cells to the temporary array
-    for (i = 0; i < mFallingBlock.size; ++i)
+    for (int i = 0; i < tetromino->size; ++i)
     {
-        for (j = 0; j < mFallingBlock.size; ++j)
+        for (int j = 0; j < tetromino->size; ++j)
         {
             if (clockwise)
             {
-                rotated[mFallingBlock.size - j - 1][i] = mFallingBlock.cells[i][j];
+                rotated[tetromino->size - j - 1][i] = tetromino->cells[i][j];
             }
             else
             {
-                rotated[j][mFallingBlock.size - i - 1] = mFallingBlock.cells[i][j];
+                rotated[j][tetromino->size - i - 1] = tetromino->cells[i][j];
             }
         }
     }
+    memcpy(tetromino->cells, rotated, sizeof(rotated));
+}
+
+// Rotate falling tetromino. If there are no collisions when the
+// tetromino is rotated this modifies the tetromino's cell buffer.
+void Game::rotateTetromino(bool clockwise)
+{
+    int i, j;
+    StcTetromino rotated;  // temporary tetromino to hold rotated cells
+
+    // If TETROMINO_O is falling return immediately
+    if (mFallingBlock.type == TETROMINO_O)
+    {
+        return; // rotation doesn't require any changes
+    }
+
+    // Copy rotated cells to the temporary tetromino
+    rotated = mFallingBlock;
+    rotateCells(&rotated, clockwise);
 #ifdef STC_WALL_KICK_ENABLED
     int wallDisplace = 0;
 
@@ -198,7 +216,7 @@ void Game::rotateTetromino(bool clockwise)
         {
             for (j = 0; j < mFallingBlock.size; ++j)
             {
-                if (rotated[i][j] != EMPTY_CELL)
+                if (rotated.cells[i][j] != EMPTY_CELL)
                 {
                     wallDisplace = i - mFallingBlock.x;
                     break;
@@ -214,7 +232,7 @@ void Game::rotateTetromino(bool clockwise)
         {
             for (j = 0; j < mFallingBlock.size; ++j)
             {
-                if (rotated[i][j] != EMPTY_CELL)
+                if (rotated.cells[i][j] != EMPTY_CELL)
                 {
                     wallDisplace = -mFallingBlock.x - i + BOARD_TILEMAP_WIDTH - 1;
                     break;
@@ -228,7 +246,7 @@ void Game::rotateTetromino(bool clockwise)
     {
         for (j = 0; j < mFallingBlock.size; ++j)
         {
-            if (rotated[i][j] != EMPTY_CELL)
+            if (rotated.cells[i][j] != EMPTY_CELL)
             {
                 // Check collision with bottom border of the map
                 if (mFallingBlock.y + j >= BOARD_TILEMAP_HEIGHT)
@@ -256,7 +274,7 @@ void Game::rotateTetromino(bool clockwise)
     {
         for (j = 0; j < mFallingBlock.size; ++j)
         {
-            if (rotated[i][j] != EMPTY_CELL)
+            if (rotated.cells[i][j] != EMPTY_CELL)
             {
                 // Check collision with left, right or bottom borders of the map
                 if ((mFallingBlock.x + i < 0) 
@@ -277,13 +295,7 @@ void Game::rotateTetromino(bool clockwise)
 #endif // STC_WALL_KICK_ENABLED
 
     // There are no collisions, replace tetromino cells with rotated cells
-    for (i = 0; i < TETROMINO_SIZE; ++i)
-    {
-        for (j = 0; j < TETROMINO_SIZE; ++j)
-        {
-            mFallingBlock.cells[i][j] = rotated[i][j];
-        }
-    }
+    memcpy(mFallingBlock.cells, rotated.cells, sizeof(rotated.cells));
     onTetrominoMoved();
 }
 
@@ -344,11 +356,13 @@ void Game::onFilledRows(int filledRows)
         // This shouldn't happen, but if happens kill the game
         mErrorCode = ERROR_ASSERT;
     }
+    onStatsChanged(STAT_LINES | STAT_SCORE);
 
     // Check if we need to update the level
     if (mStats.lines >= FILLED_ROWS_FOR_LEVEL_UP * (mStats.level + 1))
     {
         mStats.level++;
+        onStatsChanged(STAT_LEVEL);
 
         // Increase speed for falling tetrominoes
         mFallingDelay = (int)(DELAY_FACTOR_FOR_LEVEL_UP * mFallingDelay 
@@ -363,6 +377,7 @@ void Game::onFilledRows(int filledRows)
 // lands a falling tetromino, also checks for game over condition.
 void Game::moveTetromino(int x, int y)
 {
+    STC_TRACE_SPAN("moveTetromino");
     int i, j;
 
     // Check if the move would create a collision
@@ -376,6 +391,7 @@ void Game::moveTetromino(int x, int y)
             if (mFallingBlock.y <= 1)
             {
                 mIsOver = true; // if this happens the game is over
+                mChanges.flags |= CHANGE_OVER;
             }
             else
             {
@@ -389,36 +405,42 @@ void Game::moveTetromino(int x, int y)
                         {
                             mMap[mFallingBlock.x + i][mFallingBlock.y + j]
                                     = mFallingBlock.cells[i][j];
+                            onCellLocked(mFallingBlock.x + i, mFallingBlock.y + j);
                         }
                     }
                 }
 
                 // Check if the landing tetromino has created full rows
                 int numFilledRows = 0;
-                for (j = 1; j < BOARD_TILEMAP_HEIGHT; ++j)
                 {
-                    bool hasFullRow = true;
-                    for (i = 0; i < BOARD_TILEMAP_WIDTH; ++i)
+                    STC_TRACE_SPAN("clearRows");
+                    for (j = 1; j < BOARD_TILEMAP_HEIGHT; ++j)
                     {
-                        if (mMap[i][j] == EMPTY_CELL)
+                        bool hasFullRow = true;
+                        for (i = 0; i < BOARD_TILEMAP_WIDTH; ++i)
                         {
-                            hasFullRow = false;
-                            break;
+                            if (mMap[i][j] == EMPTY_CELL)
+                            {
+                                hasFullRow = false;
+                                break;
+                            }
                         }
-                    }
 
-                    // If we found a full row we need to remove that row from the map
-                    // we do that by just moving all the above rows one row below
-                    if (hasFullRow)
-                    {
-                        for (x = 0; x < BOARD_TILEMAP_WIDTH; ++x)
+                        // If we found a full row we need to remove that row from the map
+                        // we do that by just moving all the above rows one row below
+                        if (hasFullRow)
                         {
-                            for (y = j; y > 0; --y)
+                            for (x = 0; x < BOARD_TILEMAP_WIDTH; ++x)
                             {
-                                mMap[x][y] = mMap[x][y - 1];
+                                for (y = j; y > 0; --y)
+                                {
+                                    mMap[x][y] = mMap[x][y - 1];
+                                }
                             }
+                            numFilledRows++; // increase filled row counter
+                            mChanges.flags |= CHANGE_ROWS;
+                            mChanges.clearedRows |= 1u << j;
                         }
-                        numFilledRows++; // increase filled row counter
                     }
                 }
 
@@ -429,6 +451,7 @@ void Game::moveTetromino(int x, int y)
                 }
                 mStats.totalPieces++;
                 mStats.pieces[mFallingBlock.type]++;
+                onStatsChanged(STAT_TOTAL_PIECES | (STAT_PIECES << mFallingBlock.type));
 
                 // Use preview tetromino as falling tetromino.
                 // Copy preview tetromino for falling tetromino
@@ -449,6 +472,7 @@ void Game::moveTetromino(int x, int y)
 
                 // Create next preview tetromino
                 setTetromino(mPlatform->random() % TETROMINO_TYPES, &mNextBlock);
+                mChanges.flags |= CHANGE_PREVIEW;
             }
         }
     }
@@ -482,6 +506,7 @@ void Game::dropTetromino()
         mStats.score += (long)(SCORE_2_FILLED_ROW * (mStats.level + 1)
                                / SCORE_DROP_DIVISOR);
     }
+    onStatsChanged(STAT_SCORE);
 #else
     int y = 0;
     // Calculate number of cells to drop
@@ -492,16 +517,217 @@ void Game::dropTetromino()
     // Update score
     mStats.score += (long)(SCORE_2_FILLED_ROW * (mStats.level + 1) 
                            / SCORE_DROP_DIVISOR);
+    onStatsChanged(STAT_SCORE);
 #endif
 
 	mPlatform->onPieceDrop();
 }
 
+// Fill the shapes of the falling tetromino for every number of rotations
+void Game::placementShapes(StcPlacementShape *shapes)
+{
+    int i, j;
+    StcTetromino block = mFallingBlock;
+    for (int r = 0; r < PLACEMENT_ROTATIONS; ++r)
+    {
+        StcPlacementShape &shape = shapes[r];
+
+        // Rotate like rotateTetromino, the O tetromino doesn't rotate
+        if (r > 0 && block.type != TETROMINO_O)
+        {
+            rotateCells(&block, true);
+        }
+        shape.block = block;
+
+        // Row bitmasks, shifted to the leftmost cell
+        shape.left = TETROMINO_SIZE;
+        int right = -1;
+        for (j = 0; j < TETROMINO_SIZE; ++j)
+        {
+            shape.rows[j] = 0;
+            for (i = 0; i < TETROMINO_SIZE; ++i)
+            {
+                if (block.cells[i][j] != EMPTY_CELL)
+                {
+                    shape.rows[j] |= 1u << i;
+                    shape.left = (i < shape.left)? i : shape.left;
+                    right = (i > right)? i : right;
+                }
+            }
+        }
+        shape.width = right - shape.left + 1;
+        for (j = 0; j < TETROMINO_SIZE; ++j)
+        {
+            shape.rows[j] >>= shape.left;
+        }
+
+        // Compare with the previous rotations without the empty top rows
+        shape.unique = true;
+        int top = 0;
+        while (top < TETROMINO_SIZE - 1 && shape.rows[top] == 0)
+        {
+            ++top;
+        }
+        for (int k = 0; shape.unique && (k < r); ++k)
+        {
+            int otherTop = 0;
+            while (otherTop < TETROMINO_SIZE - 1 && shapes[k].rows[otherTop] == 0)
+            {
+                ++otherTop;
+            }
+            bool same = true;
+            for (j = 0; same && (j < TETROMINO_SIZE); ++j)
+            {
+                unsigned int row = (top + j < TETROMINO_SIZE)? shape.rows[top + j] : 0;
+                unsigned int otherRow = (otherTop + j < TETROMINO_SIZE)? shapes[k].rows[otherTop + j] : 0;
+                same = (row == otherRow);
+            }
+            shape.unique = !same;
+        }
+    }
+}
+
+// Write the locked cells as row bitmasks, bit i of a row is the column i
+void Game::boardRows(unsigned int *rows)
+{
+    for (int j = 0; j < BOARD_TILEMAP_HEIGHT; ++j)
+    {
+        rows[j] = 0;
+    }
+    for (int i = 0; i < BOARD_TILEMAP_WIDTH; ++i)
+    {
+        for (int j = 0; j < BOARD_TILEMAP_HEIGHT; ++j)
+        {
+            if (mMap[i][j] != EMPTY_CELL)
+            {
+                rows[j] |= 1u << i;
+            }
+        }
+    }
+}
+
+// Return true if [shape] fits on [board] with its leftmost cell at [column]
+// and the top of its buffer at the row [y]
+bool Game::shapeFits(const unsigned int *board, const StcPlacementShape &shape, int column, int y)
+{
+    if (column < 0 || column + shape.width > BOARD_TILEMAP_WIDTH)
+    {
+        return false;
+    }
+    for (int j = 0; j < TETROMINO_SIZE; ++j)
+    {
+        if (shape.rows[j] != 0)
+        {
+            if (y + j >= BOARD_TILEMAP_HEIGHT)
+            {
+                return false;
+            }
+            if (y + j >= 0 && (board[y + j] & (shape.rows[j] << column)) != 0)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Find the placements the falling tetromino can reach
+int Game::findPlacements(unsigned char *mask)
+{
+    StcPlacementShape shapes[PLACEMENT_ROTATIONS];
+    return findPlacements(mask, shapes);
+}
+
+// Find the placements with the board as row bitmasks, every position is
+// tested with one AND per row of the tetromino
+int Game::findPlacements(unsigned char *mask, StcPlacementShape *shapes)
+{
+    unsigned int board[BOARD_TILEMAP_HEIGHT];
+    boardRows(board);
+    placementShapes(shapes);
+    memset(mask, 0, PLACEMENT_COUNT);
+
+    int count = 0;
+    int y = mFallingBlock.y;
+    for (int r = 0; r < PLACEMENT_ROTATIONS; ++r)
+    {
+        // Every rotation is done in place from the previous one
+        const StcPlacementShape &shape = shapes[r];
+        int start = mFallingBlock.x + shape.left;
+        if (!shapeFits(board, shape, start, y))
+        {
+            break;
+        }
+        if (!shape.unique)
+        {
+            continue;
+        }
+
+        // Move along the row to the left and to the right, and drop
+        for (int step = -1; step <= 1; step += 2)
+        {
+            int column = (step < 0)? start : start + 1;
+            for (; shapeFits(board, shape, column, y); column += step)
+            {
+                mask[r * BOARD_TILEMAP_WIDTH + column] = 1;
+                ++count;
+            }
+        }
+    }
+    return count;
+}
+
+// Move the falling tetromino to a placement and drop it
+bool Game::place(int placement)
+{
+    unsigned char mask[PLACEMENT_COUNT];
+    StcPlacementShape shapes[PLACEMENT_ROTATIONS];
+    if (placement < 0 || placement >= PLACEMENT_COUNT
+            || findPlacements(mask, shapes) == 0 || mask[placement] == 0)
+    {
+        return false;
+    }
+    const StcPlacementShape &shape = shapes[placement / BOARD_TILEMAP_WIDTH];
+    for (int i = 0; i < TETROMINO_SIZE; ++i)
+    {
+        for (int j = 0; j < TETROMINO_SIZE; ++j)
+        {
+            mFallingBlock.cells[i][j] = shape.block.cells[i][j];
+        }
+    }
+    mFallingBlock.x = placement % BOARD_TILEMAP_WIDTH - shape.left;
+    onTetrominoMoved();
+    dropTetromino();
+
+    // If the next tetromino can't fall the next update would lock it at
+    // the top and end the game, do it now
+    if (!mIsOver && checkCollision(0, 1))
+    {
+        moveTetromino(0, 1);
+    }
+    return true;
+}
+
 // Main function game called every frame
 void Game::update()
 {
+    STC_TRACE_SPAN("update");
+
+    if (mProfiler != NULL)
+    {
+        mProfiler->beginFrame(FrameProfiler::PHASE_EVENTS);
+    }
+
     // Read player input
-    mPlatform->processEvents();
+    {
+        STC_TRACE_SPAN("processEvents");
+        mPlatform->processEvents();
+    }
+
+    if (mProfiler != NULL)
+    {
+        mProfiler->begin(FrameProfiler::PHASE_LOGIC);
+    }
 
     // Update game state
     if (mIsOver)
@@ -518,6 +744,10 @@ void Game::update()
         if ((mEvents & EVENT_RESTART) != 0)
         {
             start();
+            if (mProfiler != NULL)
+            {
+                mProfiler->endFrame();
+            }
 			return;
         }
 		
@@ -568,6 +798,7 @@ void Game::update()
         if ((mEvents & EVENT_PAUSE) != 0)
         {
             mIsPaused = !mIsPaused;
+            mChanges.flags |= CHANGE_PAUSE;
             mEvents = EVENT_NONE;
         }
 
@@ -585,13 +816,13 @@ void Game::update()
                 if ((mEvents & EVENT_SHOW_NEXT) != 0)
                 {
                     mShowPreview = !mShowPreview;
-                    mStateChanged = true;
+                    mChanges.flags |= CHANGE_SHOW_PREVIEW;
                 }
 #ifdef STC_SHOW_GHOST_PIECE
                 if ((mEvents & EVENT_SHOW_SHADOW) != 0)
                 {
                     mShowShadow = !mShowShadow;
-                    mStateChanged = true;
+                    mChanges.flags |= CHANGE_SHOW_SHADOW;
                 }
 #endif
                 if ((mEvents & EVENT_DROP) != 0)
@@ -618,6 +849,7 @@ void Game::update()
                     // Update score if the player accelerates downfall
                     mStats.score += (long)(SCORE_2_FILLED_ROW * (mStats.level + 1) 
                                            / SCORE_MOVE_DOWN_DIVISOR);
+                    onStatsChanged(STAT_SCORE);
 
                     moveTetromino(0, 1);
                 }
@@ -634,8 +866,43 @@ void Game::update()
         // Save current time for next game update
         mSystemTime = currentTime;
     }
+    if (mProfiler != NULL)
+    {
+        mProfiler->begin(FrameProfiler::PHASE_RENDER);
+    }
+
     // Draw game state
-    mPlatform->renderGame();
+    {
+        STC_TRACE_SPAN("renderGame");
+        mPlatform->renderGame();
+    }
+
+    if (mProfiler != NULL)
+    {
+        mProfiler->endFrame();
+    }
+}
+
+// Replace the falling tetromino
+void Game::setFallingBlock(const StcTetromino &block)
+{
+    mFallingBlock = block;
+    onTetrominoMoved();
+}
+
+// Replace the next tetromino
+void Game::setNextBlock(const StcTetromino &block)
+{
+    mNextBlock = block;
+    mChanges.flags |= CHANGE_PREVIEW;
+}
+
+// Replace the cells of the board
+void Game::setBoard(const StcMap &map)
+{
+    memcpy(mMap, map, sizeof(mMap));
+    onTetrominoMoved();
+    mChanges.flags |= CHANGE_ALL;
 }
 
 // This event is called when the falling tetromino is moved
@@ -647,7 +914,45 @@ void Game::onTetrominoMoved()
     while (!checkCollision(0, ++y));
     mShadowGap = y - 1;
 #endif
-    mStateChanged = true;
+    mChanges.flags |= CHANGE_FALLING;
+}
+
+// This event is called when a cell of the falling tetromino is locked on the board
+void Game::onCellLocked(int column, int row)
+{
+    if ((mChanges.flags & CHANGE_LOCKED) == 0)
+    {
+        mChanges.flags |= CHANGE_LOCKED;
+        mChanges.lockedLeft = mChanges.lockedRight = column;
+        mChanges.lockedTop = mChanges.lockedBottom = row;
+        return;
+    }
+    if (column < mChanges.lockedLeft)  mChanges.lockedLeft = column;
+    if (column > mChanges.lockedRight) mChanges.lockedRight = column;
+    if (row < mChanges.lockedTop)      mChanges.lockedTop = row;
+    if (row > mChanges.lockedBottom)   mChanges.lockedBottom = row;
+}
+
+// This event is called when some statistic fields are modified
+void Game::onStatsChanged(unsigned int fields)
+{
+    mChanges.flags |= CHANGE_STATS;
+    mChanges.stats |= fields;
+}
+
+// The platform must call this method after processing a changed state,
+// the current state becomes the starting point for the next changes
+void Game::onChangeProcessed()
+{
+    mChanges.flags = CHANGE_NONE;
+    mChanges.stats = 0;
+    mChanges.clearedRows = 0;
+    mChanges.fromBlock = mFallingBlock;
+#ifdef STC_SHOW_GHOST_PIECE
+    mChanges.fromShadowGap = mShadowGap;
+#else
+    mChanges.fromShadowGap = 0;
+#endif
 }
 
 // Process a key down event
@@ -12,6 +12,8 @@
 #define STC_SRC_GAME_HPP_
 
 #include "platform.hpp"
+#include "profile.hpp"
+#include "trace.hpp"
 
 // Game name
 #define STC_GAME_NAME    "STC: simple tetris clone"
@@ -184,6 +186,39 @@ public:
     // This value used for empty tiles
     static const int EMPTY_CELL = -1;
 
+    // Placements of the falling tetromino, a placement is
+    // rotations * BOARD_TILEMAP_WIDTH + column, where rotations is the number
+    // of clockwise rotations and column is the column of its leftmost cell
+    static const int PLACEMENT_ROTATIONS = 4;
+    static const int PLACEMENT_COUNT = PLACEMENT_ROTATIONS * BOARD_TILEMAP_WIDTH;
+
+    // Change flags, they tell which parts of the game state have changed
+    // since the platform processed the last changes
+    enum
+    {
+        CHANGE_NONE         = 0,
+        CHANGE_FALLING      = 1,       // falling tetromino moved, rotated or was replaced
+        CHANGE_LOCKED       = 1 << 1,  // cells of the falling tetromino were locked
+        CHANGE_ROWS         = 1 << 2,  // filled rows were cleared
+        CHANGE_STATS        = 1 << 3,  // some statistic field changed
+        CHANGE_PREVIEW      = 1 << 4,  // next tetromino changed
+        CHANGE_SHOW_PREVIEW = 1 << 5,  // preview was toggled
+        CHANGE_SHOW_SHADOW  = 1 << 6,  // shadow was toggled
+        CHANGE_PAUSE        = 1 << 7,  // game was paused or resumed
+        CHANGE_OVER         = 1 << 8,  // game is over
+        CHANGE_ALL          = 1 << 9   // game was started, everything changed
+    };
+
+    // Statistic fields, the change set marks the ones that have changed
+    enum
+    {
+        STAT_SCORE        = 1,
+        STAT_LINES        = 1 << 1,
+        STAT_LEVEL        = 1 << 2,
+        STAT_TOTAL_PIECES = 1 << 3,
+        STAT_PIECES       = 1 << 4   // shifted by the tetromino type for every subtotal
+    };
+
     // Data structure that holds information about our tetromino blocks.
     struct StcTetromino
     {
@@ -211,23 +246,51 @@ public:
         int pieces[TETROMINO_TYPES]; // number of tetrominoes per type
     };
 
+    // Data structure that holds the changes of the game state since the
+    // last time they were processed. The new state is the current one.
+    struct StcChangeSet
+    {
+        unsigned int flags;       // CHANGE_* bits
+        unsigned int stats;       // STAT_* bits of the changed statistic fields
+        unsigned int clearedRows; // bit j is set if the board row j was cleared
+
+        // Falling tetromino and shadow gap when the changes were processed
+        StcTetromino fromBlock;
+        int fromShadowGap;
+
+        // Board area (in tiles, inclusive) containing the locked cells
+        int lockedLeft;
+        int lockedTop;
+        int lockedRight;
+        int lockedBottom;
+    };
+
     // The platform must call this method after processing a changed state
-    void onChangeProcessed()           { mStateChanged = false; }
+    void onChangeProcessed();
 
     // Return true if the game state has changed, false otherwise
-    bool hasChanged()                  { return mStateChanged; }
+    bool hasChanged()                  { return mChanges.flags != CHANGE_NONE; }
+
+    // Return the changes of the game state since they were last processed
+    StcChangeSet const &changes()      { return mChanges; }
 
     // Return the cell at the specified position
     int getCell(int column, int row)   { return mMap[column][row]; }
 
+    // Cells of the board, [column][row]
+    typedef int StcMap[BOARD_TILEMAP_WIDTH][BOARD_TILEMAP_HEIGHT];
+
+    // Return the cells of the board
+    StcMap const &map() const          { return mMap; }
+
     // Return a reference to the game statistic data
     StcStatics const &stats()          { return mStats; }
 
     // Return current falling tetromino
-    StcTetromino const &fallingBlock() { return mFallingBlock; }
+    StcTetromino const &fallingBlock() const { return mFallingBlock; }
 
     // Return next tetromino
-    StcTetromino const &nextBlock()    { return mNextBlock; }
+    StcTetromino const &nextBlock() const    { return mNextBlock; }
 
     // Return current error code
     int errorCode()     { return mErrorCode; } 
@@ -249,6 +312,55 @@ public:
     int shadowGap()     { return mShadowGap; }
 #endif
 
+    // Time the phases of the frames with [profiler], NULL to stop timing
+    void setProfiler(FrameProfiler *profiler) { mProfiler = profiler; }
+
+    // Return the frame profiler, NULL if the frames aren't timed
+    FrameProfiler *profiler()   { return mProfiler; }
+
+    // Set [mask] (PLACEMENT_COUNT bytes) to 1 for the placements the falling
+    // tetromino can reach by rotating in place, moving along its row and
+    // dropping, and to 0 for the others. Rotations with the same cells as
+    // fewer rotations are left out. Return the number of placements.
+    int findPlacements(unsigned char *mask);
+
+    // Move the falling tetromino to [placement] and drop it, return false
+    // (and change nothing) if it can't reach it
+    bool place(int placement);
+
+    // Set the platform of the game, a copy of a game keeps the platform of
+    // the original
+    void setPlatform(Platform *platform) { mPlatform = platform; }
+
+    // Replace the falling tetromino and update its shadow
+    void setFallingBlock(const StcTetromino &block);
+
+    // Replace the next tetromino
+    void setNextBlock(const StcTetromino &block);
+
+    // Replace the cells of the board and update the shadow, the platform
+    // redraws everything
+    void setBoard(const StcMap &map);
+
+    // Make the platform redraw everything in the next frame
+    void redrawAll()    { mChanges.flags |= CHANGE_ALL; }
+
+    // Stop the game with an error found by the platform
+    void setErrorCode(int errorCode) { mErrorCode = errorCode; }
+
+    // Fill [tetromino] with the cells of the tetromino [indexTetromino]
+    static void setTetromino(int indexTetromino, StcTetromino *tetromino);
+
+    // Rotate the cells of [tetromino] in its buffer, without moving it or
+    // checking collisions
+    static void rotateCells(StcTetromino *tetromino, bool clockwise);
+
+    // Steps of the engine done by update, public for the benchmarks
+    bool checkCollision(int dx, int dy);
+    void rotateTetromino(bool clockwise);
+    void moveTetromino(int x, int y);
+
+    Game();
     void init(Platform *targetPlatform);
     void end();
     void update();
@@ -262,14 +374,15 @@ private:
     unsigned int mEvents;
 
     // Matrix that holds the cells (tilemap)
-    int mMap[BOARD_TILEMAP_WIDTH][BOARD_TILEMAP_HEIGHT];
+    StcMap mMap;
 
     Platform    *mPlatform;     // platform interface
+    FrameProfiler *mProfiler;   // frame timing, NULL if disabled
     StcStatics   mStats;        // statistic data
     StcTetromino mFallingBlock; // current falling tetromino
     StcTetromino mNextBlock;    // next tetromino
 
-    bool mStateChanged; // true if game state has changed
+    StcChangeSet mChanges; // changes not yet processed by the platform
     int  mErrorCode;    // stores current error code
     bool mIsPaused;     // true if the game is over
     bool mIsOver;       // true if the game is over
@@ -292,15 +405,29 @@ private:
     int  mDelayRotation;
 #endif
 
-    void setMatrixCells(int *matrix, int width, int height, int value);
-    void setTetromino(int indexTetromino, StcTetromino *tetromino);
+    static void setMatrixCells(int *matrix, int width, int height, int value);
     void start();
-    void rotateTetromino(bool clockwise);
-    bool checkCollision(int dx, int dy);
     void onFilledRows(int filledRows);
-    void moveTetromino(int x, int y);
     void dropTetromino();
     void onTetrominoMoved();
+    void onCellLocked(int column, int row);
+    void onStatsChanged(unsigned int fields);
+
+    // Falling tetromino rotated for the placements, as row bitmasks with
+    // its leftmost cell in bit 0
+    struct StcPlacementShape
+    {
+        StcTetromino block;
+        unsigned int rows[TETROMINO_SIZE];
+        int left;   // column of the leftmost cell in the tetromino buffer
+        int width;
+        bool unique;
+    };
+
+    void placementShapes(StcPlacementShape *shapes);
+    void boardRows(unsigned int *rows);
+    static bool shapeFits(const unsigned int *board, const StcPlacementShape &shape, int column, int y);
+    int findPlacements(unsigned char *mask, StcPlacementShape *shapes);
 };
 }
 
@@ -0,0 +1,61 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Platform without input or output, for the benchmarks, the environments   */
+/*   and the tools that play games as fast as possible.                       */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#ifndef STC_SRC_HEADLESS_HPP_
+#define STC_SRC_HEADLESS_HPP_
+
+#include "game.hpp"
+#include "replay.hpp"
+
+namespace stc
+{
+
+// Platform that draws nothing, its clock advances a frame per update and
+// its random numbers come from its seed (as in replays). It sends no input,
+// platforms that play override processEvents.
+class PlatformHeadless : public Platform
+{
+public:
+    static const int FRAME_TIME = 40;
+
+    PlatformHeadless(unsigned int seed = 1)
+    {
+        mGame = NULL;
+        mSeed = seed;
+        mTime = 0;
+    }
+
+    void seed(unsigned int seed) { mSeed = seed; }
+
+    virtual int init(Game *game)        { mGame = game; return Game::ERROR_NONE; }
+    virtual void end()                  {}
+    virtual void processEvents()        {}
+    virtual long getSystemTime()        { return mTime; }
+    virtual int random()                { return Replay::random(mSeed); }
+    virtual void onLineCompleted()      {}
+    virtual void onPieceDrop()          {}
+
+    virtual void renderGame()
+    {
+        mTime += FRAME_TIME;
+        mGame->onChangeProcessed();
+    }
+
+protected:
+    Game        *mGame;
+
+private:
+    unsigned int mSeed;
+    long         mTime;
+};
+}
+
+#endif // STC_SRC_HEADLESS_HPP_
@@ -3,6 +3,17 @@
 /* -------------------------------------------------------------------------- */
 /*   A simple tetris clone.                                                   */
 /*                                                                            */
+/*   Usage: stc++ [--record <replay file>] [--low-latency [samples]]          */
+/*                [--profile] [--trace <trace file>] [--shm <name>]           */
+/*                                                                            */
+/*   --profile times the phases of every frame and writes their histograms    */
+/*   to stderr on exit, or when the process gets SIGUSR1.                     */
+/*   --trace writes the spans of all the threads as Chrome trace events, it   */
+/*   needs STC_TRACE (make stc++trace).                                       */
+/*   --shm publishes the state of the game in the POSIX shared memory         */
+/*   segment <name> (like /stc) and takes the key presses of a bot from it,   */
+/*   see shm/shm_state.hpp and tools/shm_bot.cpp.                             */
+/*                                                                            */
 /*   Some symbols you can define for the project:                             */
 /*                                                                            */
 /*   STC_SHOW_GHOST_PIECE:      define this for showing the shadow piece.     */
@@ -14,6 +25,13 @@
 /*   STC_AUTO_ROTATION:         define this for enabling auto-rotation of     */
 /*                              the falling piece.                            */
 /*                                                                            */
+/*   STC_USE_OPENGL:            define this for rendering with OpenGL.        */
+/*                                                                            */
+/*   STC_USE_SOFTWARE:          define this for rendering with the software   */
+/*                              rasterizer.                                   */
+/*                                                                            */
+/*   STC_TRACE:                 define this for recording trace spans.        */
+/*                                                                            */
 /* -------------------------------------------------------------------------- */
 /*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
 /*                                                                            */
@@ -39,17 +57,92 @@
 /*   OTHER DEALINGS IN THE SOFTWARE.                                          */
 /* -------------------------------------------------------------------------- */
 
+#if defined(STC_USE_OPENGL)
+#include "sdl/sdl_game_gl.hpp"
+#elif defined(STC_USE_SOFTWARE)
+#include "sdl/sdl_game_soft.hpp"
+#else
 #include "sdl/sdl_game.hpp"
+#endif
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
 
-int main(int, char **)
+#ifdef SIGUSR1
+// Dump the frame times at the end of the current frame
+static void onDumpSignal(int)
+{
+    stc::FrameProfiler::requestDump();
+}
+#endif
+
+int main(int argc, char **argv)
 {
     // Game object
     stc::Game game;
 
     // Platform object
+#if defined(STC_USE_OPENGL)
+    stc::PlatformSdlGl platform;
+#elif defined(STC_USE_SOFTWARE)
+    stc::PlatformSdlSoft platform;
+#else
     stc::PlatformSdl platform;
+#endif
+
+    // Frame timing, used with --profile
+    stc::FrameProfiler profiler;
+    bool profile = false;
+
+    // Trace file, used with --trace
+    const char *traceFile = NULL;
+
+    // Options
+    for (int i = 1; i < argc; ++i)
+    {
+        // Record a replay of the game
+        if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+        {
+            platform.recordReplay(argv[++i]);
+        }
+        // Play the sound effects with less delay
+        else if (strcmp(argv[i], "--low-latency") == 0)
+        {
+            int samples = 512;
+            if (i + 1 < argc && atoi(argv[i + 1]) > 0)
+            {
+                samples = atoi(argv[++i]);
+            }
+            platform.setLowLatencyAudio(samples);
+        }
+        // Time the phases of the frames
+        else if (strcmp(argv[i], "--profile") == 0)
+        {
+            profile = true;
+            game.setProfiler(&profiler);
+#ifdef SIGUSR1
+            signal(SIGUSR1, onDumpSignal);
+#endif
+        }
+#ifdef STC_TRACE
+        // Record the spans of the engine and platform
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+        {
+            traceFile = argv[++i];
+        }
+#endif
+        // Share the game state with a bot process
+        else if (strcmp(argv[i], "--shm") == 0 && i + 1 < argc)
+        {
+            platform.setSharedState(argv[++i]);
+        }
+    }
 
     // Start the game
+    if (traceFile != NULL)
+    {
+        stc::Tracer::start();
+    }
     game.init(&platform);
 
     // Loop until some error happens or the user quits
@@ -60,6 +153,15 @@ int main(int, char **)
 
     // Game was interrupted or an error happened, end the game
     game.end();
+    if (profile)
+    {
+        profiler.dump(stderr);
+    }
+    if (traceFile != NULL)
+    {
+        stc::Tracer::stop();
+        stc::Tracer::write(traceFile);
+    }
 
     // Return to the system
     return game.errorCode();
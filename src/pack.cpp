@@ -0,0 +1,178 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Asset pack reader.                                                       */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "pack.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace stc
+{
+
+const char AssetPack::MAGIC[MAGIC_LENGTH + 1] = "STCPACK1";
+
+AssetPack::AssetPack()
+{
+    mData = NULL;
+    mSize = 0;
+    mCount = 0;
+    mMapped = false;
+    mAllocated = false;
+}
+
+AssetPack::~AssetPack()
+{
+    close();
+}
+
+// Map a pack file, return false if it doesn't exist or it is not valid
+bool AssetPack::open(const char *file)
+{
+    close();
+#ifndef _WIN32
+    int fd = ::open(file, O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0)
+    {
+        void *data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED)
+        {
+            mData = (const unsigned char *)data;
+            mSize = (size_t)info.st_size;
+            mMapped = true;
+        }
+    }
+    ::close(fd);
+#else
+    // Read the whole file, there is no mmap
+    FILE *input = fopen(file, "rb");
+    if (input == NULL)
+    {
+        return false;
+    }
+    long size = (fseek(input, 0, SEEK_END) == 0)? ftell(input) : -1;
+    if (size > 0 && fseek(input, 0, SEEK_SET) == 0)
+    {
+        unsigned char *data = (unsigned char *)malloc((size_t)size);
+        if (data != NULL && fread(data, 1, (size_t)size, input) == (size_t)size)
+        {
+            mData = data;
+            mSize = (size_t)size;
+            mAllocated = true;
+        }
+        else
+        {
+            free(data);
+        }
+    }
+    fclose(input);
+#endif
+    if (mData == NULL || !validate())
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+// Use a pack already in memory
+bool AssetPack::openMemory(const void *data, size_t size)
+{
+    close();
+    mData = (const unsigned char *)data;
+    mSize = size;
+    if (!validate())
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+// Check the header and that all the entries are inside the pack
+bool AssetPack::validate()
+{
+    if (mSize < (size_t)HEADER_SIZE || memcmp(mData, MAGIC, MAGIC_LENGTH) != 0)
+    {
+        return false;
+    }
+    unsigned int count = readInt(mData + MAGIC_LENGTH);
+    if (count > (mSize - HEADER_SIZE) / ENTRY_SIZE)
+    {
+        return false;
+    }
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        const unsigned char *entry = mData + HEADER_SIZE + ENTRY_SIZE * i;
+        unsigned int offset = readInt(entry + NAME_LENGTH);
+        unsigned int size = readInt(entry + NAME_LENGTH + 4);
+        if (entry[NAME_LENGTH - 1] != '\0' || offset > mSize || size > mSize - offset)
+        {
+            return false;
+        }
+    }
+    mCount = (int)count;
+    return true;
+}
+
+// Find the data of an asset, return false if it isn't in the pack
+bool AssetPack::find(const char *name, const void **data, size_t *size) const
+{
+    for (int i = 0; i < mCount; ++i)
+    {
+        const unsigned char *entry = mData + HEADER_SIZE + ENTRY_SIZE * i;
+        if (strcmp((const char *)entry, name) == 0)
+        {
+            *data = mData + readInt(entry + NAME_LENGTH);
+            *size = readInt(entry + NAME_LENGTH + 4);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Read a 32 bits little endian integer
+unsigned int AssetPack::readInt(const unsigned char *bytes)
+{
+    return (unsigned int)bytes[0] | ((unsigned int)bytes[1] << 8)
+           | ((unsigned int)bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+}
+
+// Unmap the pack file
+void AssetPack::close()
+{
+#ifndef _WIN32
+    if (mMapped)
+    {
+        munmap((void *)mData, mSize);
+    }
+#endif
+    if (mAllocated)
+    {
+        free((void *)mData);
+    }
+    mData = NULL;
+    mSize = 0;
+    mCount = 0;
+    mMapped = false;
+    mAllocated = false;
+}
+}
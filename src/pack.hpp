@@ -0,0 +1,78 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Asset pack, all the asset files in a single file.                        */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#ifndef STC_SRC_PACK_HPP_
+#define STC_SRC_PACK_HPP_
+
+#include <cstddef>
+
+namespace stc
+{
+
+// Pack file used instead of the asset files if it exists
+#define STC_ASSET_PACK          "assets.pak"
+
+// Read only view of an asset pack. The pack file is mapped in memory, so
+// the assets are used from the mapped pages without copies.
+//
+//  Pack layout (integers are 32 bits little endian):
+//      magic "STCPACK1"
+//      number of entries
+//      entries: name (zero padded), offset and size of the data
+//      data of the entries, every one aligned to DATA_ALIGNMENT bytes
+//
+class AssetPack
+{
+public:
+    static const int MAGIC_LENGTH   = 8;
+    static const int NAME_LENGTH    = 56;
+    static const int HEADER_SIZE    = MAGIC_LENGTH + 4;
+    static const int ENTRY_SIZE     = NAME_LENGTH + 8;
+    static const int DATA_ALIGNMENT = 16;
+
+    // Identifier at the start of the pack
+    static const char MAGIC[MAGIC_LENGTH + 1];
+
+    AssetPack();
+    ~AssetPack();
+
+    // Map a pack file, return false if it doesn't exist or it is not valid
+    bool open(const char *file);
+
+    // Use a pack already in memory (an embedded pack)
+    bool openMemory(const void *data, size_t size);
+
+    // Find the data of an asset, return false if it isn't in the pack
+    bool find(const char *name, const void **data, size_t *size) const;
+
+    // Return true if a pack is open
+    bool isOpen() const     { return mData != NULL; }
+
+    // Unmap the pack file
+    void close();
+
+private:
+
+    const unsigned char *mData;
+    size_t mSize;
+    int    mCount;
+    bool   mMapped;    // mapped file, unmapped on close
+    bool   mAllocated; // file read in memory, freed on close
+
+    bool validate();
+    static unsigned int readInt(const unsigned char *bytes);
+
+    // Not copyable
+    AssetPack(const AssetPack &);
+    AssetPack &operator=(const AssetPack &);
+};
+}
+
+#endif // STC_SRC_PACK_HPP_
@@ -0,0 +1,256 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Frame timing: time spent in every phase of the frames.                   */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "profile.hpp"
+#include <csignal>
+#include <cstring>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace stc
+{
+
+// Set by requestDump(), checked at the end of the frames
+static volatile sig_atomic_t gDumpRequested = 0;
+
+// Names of the phases in the dumps
+static const char *PHASE_NAMES[FrameProfiler::PHASE_COUNT] =
+{
+    "events", "logic", "render", "sleep"
+};
+
+TimeHistogram::TimeHistogram()
+{
+    reset();
+}
+
+// Remove all the durations
+void TimeHistogram::reset()
+{
+    memset(mBuckets, 0, sizeof(mBuckets));
+    mCount = 0;
+    mMaximum = 0;
+    mTotal = 0.0;
+}
+
+// Add the durations of [other]
+void TimeHistogram::add(const TimeHistogram &other)
+{
+    for (int i = 0; i < BUCKET_COUNT; ++i)
+    {
+        mBuckets[i] += other.mBuckets[i];
+    }
+    mCount += other.mCount;
+    mTotal += other.mTotal;
+    if (other.mMaximum > mMaximum)
+    {
+        mMaximum = other.mMaximum;
+    }
+}
+
+// Return the bucket of a duration
+int TimeHistogram::bucketOf(unsigned long micros)
+{
+    if (micros > 0xFFFFFFFFUL)
+    {
+        micros = 0xFFFFFFFFUL;
+    }
+    if (micros < (unsigned long)(2 * SUB_BUCKETS))
+    {
+        return (int)micros;
+    }
+    int shift = 0;
+    while ((micros >> shift) >= (unsigned long)(2 * SUB_BUCKETS))
+    {
+        ++shift;
+    }
+    return shift * SUB_BUCKETS + (int)(micros >> shift);
+}
+
+// Return the lowest duration of a bucket
+unsigned long TimeHistogram::bucketLow(int bucket)
+{
+    if (bucket < 2 * SUB_BUCKETS)
+    {
+        return (unsigned long)bucket;
+    }
+    int shift = bucket / SUB_BUCKETS - 1;
+    return (unsigned long)(bucket - shift * SUB_BUCKETS) << shift;
+}
+
+// Return the highest duration of a bucket
+unsigned long TimeHistogram::bucketHigh(int bucket)
+{
+    if (bucket < 2 * SUB_BUCKETS)
+    {
+        return (unsigned long)bucket;
+    }
+    int shift = bucket / SUB_BUCKETS - 1;
+    return bucketLow(bucket) + ((1UL << shift) - 1);
+}
+
+// Add a duration
+void TimeHistogram::record(unsigned long micros)
+{
+    ++mBuckets[bucketOf(micros)];
+    ++mCount;
+    mTotal += micros;
+    if (micros > mMaximum)
+    {
+        mMaximum = micros;
+    }
+}
+
+// Return the duration below or equal to which are [percent] of the durations
+unsigned long TimeHistogram::percentile(double percent) const
+{
+    if (mCount == 0)
+    {
+        return 0;
+    }
+    double wanted = mCount * percent / 100.0;
+    unsigned long seen = 0;
+    for (int i = 0; i < BUCKET_COUNT; ++i)
+    {
+        seen += mBuckets[i];
+        if (seen > 0 && seen >= wanted)
+        {
+            unsigned long high = bucketHigh(i);
+            return (high < mMaximum)? high : mMaximum;
+        }
+    }
+    return mMaximum;
+}
+
+// Write the summary and the used buckets
+void TimeHistogram::dump(FILE *output, const char *name) const
+{
+    fprintf(output, "%-7s frames %lu  mean %.1f  p50 %lu  p90 %lu  p99 %lu  p99.9 %lu  max %lu (us)\n",
+            name, mCount, mean(), percentile(50.0), percentile(90.0),
+            percentile(99.0), percentile(99.9), mMaximum);
+    for (int i = 0; i < BUCKET_COUNT; ++i)
+    {
+        if (mBuckets[i] > 0)
+        {
+            fprintf(output, "    %lu-%lu: %lu\n", bucketLow(i), bucketHigh(i), mBuckets[i]);
+        }
+    }
+}
+
+FrameProfiler::FrameProfiler()
+{
+    reset();
+}
+
+// Remove all the recorded times
+void FrameProfiler::reset()
+{
+    for (int i = 0; i < PHASE_COUNT; ++i)
+    {
+        mHistograms[i].reset();
+        mPhaseTime[i] = 0;
+    }
+    mFrames.reset();
+    mFrameStart = 0;
+    mPhaseStart = 0;
+    mPhase = PHASE_EVENTS;
+    mInFrame = false;
+}
+
+// Start a frame in the phase [phase]
+void FrameProfiler::beginFrame(Phase phase)
+{
+    for (int i = 0; i < PHASE_COUNT; ++i)
+    {
+        mPhaseTime[i] = 0;
+    }
+    mFrameStart = now();
+    mPhaseStart = mFrameStart;
+    mPhase = phase;
+    mInFrame = true;
+}
+
+// End the current phase and start [phase]
+void FrameProfiler::begin(Phase phase)
+{
+    if (!mInFrame)
+    {
+        return;
+    }
+    unsigned long time = now();
+    mPhaseTime[mPhase] += time - mPhaseStart;
+    mPhaseStart = time;
+    mPhase = phase;
+}
+
+// End the frame and record the time of its phases
+void FrameProfiler::endFrame()
+{
+    if (!mInFrame)
+    {
+        return;
+    }
+    unsigned long time = now();
+    mPhaseTime[mPhase] += time - mPhaseStart;
+    for (int i = 0; i < PHASE_COUNT; ++i)
+    {
+        mHistograms[i].record(mPhaseTime[i]);
+    }
+    mFrames.record(time - mFrameStart);
+    mInFrame = false;
+
+    if (gDumpRequested != 0)
+    {
+        gDumpRequested = 0;
+        dump(stderr);
+    }
+}
+
+// Write the histograms of all the phases
+void FrameProfiler::dump(FILE *output) const
+{
+    for (int i = 0; i < PHASE_COUNT; ++i)
+    {
+        mHistograms[i].dump(output, PHASE_NAMES[i]);
+    }
+    mFrames.dump(output, "frame");
+    fflush(output);
+}
+
+// Ask to dump the histograms at the end of the next frame
+void FrameProfiler::requestDump()
+{
+    gDumpRequested = 1;
+}
+
+// Return the time of the monotonic clock in microseconds
+unsigned long FrameProfiler::now()
+{
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    if (frequency.QuadPart == 0)
+    {
+        QueryPerformanceFrequency(&frequency);
+    }
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    return (unsigned long)((counter.QuadPart / frequency.QuadPart) * 1000000
+                           + (counter.QuadPart % frequency.QuadPart) * 1000000 / frequency.QuadPart);
+#else
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (unsigned long)time.tv_sec * 1000000UL + (unsigned long)(time.tv_nsec / 1000);
+#endif
+}
+}
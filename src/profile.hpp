@@ -0,0 +1,120 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Frame timing: time spent in every phase of the frames.                   */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#ifndef STC_SRC_PROFILE_HPP_
+#define STC_SRC_PROFILE_HPP_
+
+#include <cstdio>
+
+namespace stc
+{
+
+// Histogram of durations in microseconds. Buckets are exact below
+// 2 * SUB_BUCKETS and then have SUB_BUCKETS buckets for every power of two,
+// so the error of a recorded value is less than 1 / SUB_BUCKETS. Recording
+// is a few integer operations and doesn't allocate.
+class TimeHistogram
+{
+public:
+    static const int SUB_BITS    = 5;
+    static const int SUB_BUCKETS = 1 << SUB_BITS;
+
+    // Buckets needed for 32 bits values
+    static const int BUCKET_COUNT = 2 * SUB_BUCKETS + (31 - SUB_BITS) * SUB_BUCKETS;
+
+    TimeHistogram();
+
+    // Add a duration
+    void record(unsigned long micros);
+
+    // Remove all the durations
+    void reset();
+
+    // Add the durations of [other]
+    void add(const TimeHistogram &other);
+
+    // Return the duration below or equal to which are [percent] of the
+    // recorded durations (rounded up to the end of its bucket)
+    unsigned long percentile(double percent) const;
+
+    unsigned long count() const  { return mCount; }
+    unsigned long maximum() const { return mMaximum; }
+    double mean() const  { return (mCount > 0)? mTotal / mCount : 0.0; }
+
+    // Write the summary and the used buckets
+    void dump(FILE *output, const char *name) const;
+
+private:
+
+    unsigned long mBuckets[BUCKET_COUNT];
+    unsigned long mCount;
+    unsigned long mMaximum;
+    double mTotal;
+
+    static int bucketOf(unsigned long micros);
+    static unsigned long bucketLow(int bucket);
+    static unsigned long bucketHigh(int bucket);
+};
+
+// Times the phases of the frames with a monotonic clock. A frame is split
+// in phases with begin(), the time of a phase lasts until the next call to
+// begin() or endFrame(). The times of every frame are added to the
+// histogram of its phases.
+class FrameProfiler
+{
+public:
+    enum Phase
+    {
+        PHASE_EVENTS,  // Platform::processEvents
+        PHASE_LOGIC,   // game state update
+        PHASE_RENDER,  // Platform::renderGame, without the sleep
+        PHASE_SLEEP,   // wait for the next frame
+        PHASE_COUNT
+    };
+
+    FrameProfiler();
+
+    // Start a frame in the phase [phase]
+    void beginFrame(Phase phase);
+
+    // End the current phase and start [phase]
+    void begin(Phase phase);
+
+    // End the frame and record the time of its phases
+    void endFrame();
+
+    // Remove all the recorded times
+    void reset();
+
+    const TimeHistogram &histogram(Phase phase) const { return mHistograms[phase]; }
+
+    // Write the histograms of all the phases
+    void dump(FILE *output) const;
+
+    // Ask to dump the histograms to stderr at the end of the next frame,
+    // it can be called from a signal handler
+    static void requestDump();
+
+    // Return the time of the monotonic clock in microseconds (it wraps)
+    static unsigned long now();
+
+private:
+
+    TimeHistogram mHistograms[PHASE_COUNT];
+    TimeHistogram mFrames;                    // whole frames
+    unsigned long mPhaseTime[PHASE_COUNT];    // time in each phase this frame
+    unsigned long mFrameStart;
+    unsigned long mPhaseStart;
+    Phase mPhase;
+    bool  mInFrame;
+};
+}
+
+#endif // STC_SRC_PROFILE_HPP_
@@ -0,0 +1,198 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Game replays.                                                            */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "replay.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+
+namespace stc
+{
+
+// Maximum length of a line of a replay file
+static const int REPLAY_LINE_LENGTH = 1024;
+
+Replay::Replay()
+{
+    start(0, 0);
+}
+
+// Forget all the updates and start a new replay
+void Replay::start(unsigned int seed, long time)
+{
+    mSeed = seed;
+    mStartTime = time;
+    mFrameTimes.clear();
+    mFirstEvents.clear();
+    mEvents.clear();
+}
+
+// Add a game update
+void Replay::addFrame(long time)
+{
+    mFrameTimes.push_back(time);
+    mFirstEvents.push_back((int)mEvents.size());
+}
+
+// Add an event to the last update
+void Replay::addEvent(int event, bool start)
+{
+    mEvents.push_back(start? event : -event);
+}
+
+// Return the number of events of an update
+int Replay::eventCount(int frame) const
+{
+    int last = (frame + 1 < frameCount())? mFirstEvents[frame + 1] : (int)mEvents.size();
+    return last - mFirstEvents[frame];
+}
+
+// Save the replay, return false on error
+bool Replay::save(const char *file) const
+{
+    FILE *output = fopen(file, "w");
+    if (output == NULL)
+    {
+        return false;
+    }
+    fprintf(output, "STC-REPLAY %d\nseed %u\ntime %ld\n", VERSION, mSeed, mStartTime);
+    for (int frame = 0; frame < frameCount(); ++frame)
+    {
+        fprintf(output, "%ld", mFrameTimes[frame]);
+        for (int i = 0; i < eventCount(frame); ++i)
+        {
+            fprintf(output, " %+d", event(frame, i));
+        }
+        fputc('\n', output);
+    }
+    return (fclose(output) == 0);
+}
+
+// Load a replay, return false on error
+bool Replay::load(const char *file)
+{
+    FILE *input = fopen(file, "r");
+    if (input == NULL)
+    {
+        return false;
+    }
+
+    int version = 0;
+    unsigned int seed = 0;
+    long time = 0;
+    if (fscanf(input, "STC-REPLAY %d seed %u time %ld", &version, &seed, &time) != 3
+            || version != VERSION)
+    {
+        fclose(input);
+        return false;
+    }
+    start(seed, time);
+
+    char line[REPLAY_LINE_LENGTH];
+    while (fgets(line, REPLAY_LINE_LENGTH, input) != NULL)
+    {
+        char *next;
+        long frameTime = strtol(line, &next, 10);
+        if (next == line)
+        {
+            continue; // empty line
+        }
+        addFrame(frameTime);
+        for (;;)
+        {
+            char *value = next;
+            int event = (int)strtol(value, &next, 10);
+            if (next == value)
+            {
+                break;
+            }
+            mEvents.push_back(event);
+        }
+    }
+    fclose(input);
+    return true;
+}
+
+// Linear congruential generator, the same numbers on every platform
+int Replay::random(unsigned int &state)
+{
+    state = state * 1103515245u + 12345u;
+    return (int)((state >> 16) & 0x7fff);
+}
+
+//------------------------------------------------------------------------------
+// Replay platform
+
+PlatformReplay::PlatformReplay(const Replay &replay) : mReplay(replay)
+{
+    mGame = NULL;
+    mFrame = 0;
+    mTime = 0;
+    mRandomState = 0;
+}
+
+int PlatformReplay::init(Game *game)
+{
+    mGame = game;
+    mFrame = 0;
+    mTime = mReplay.startTime();
+    mRandomState = mReplay.seed();
+    return Game::ERROR_NONE;
+}
+
+void PlatformReplay::end()
+{
+}
+
+// Send the events of the next update
+void PlatformReplay::processEvents()
+{
+    if (isFinished())
+    {
+        mGame->onEventStart(Game::EVENT_QUIT);
+        return;
+    }
+    mTime = mReplay.frameTime(mFrame);
+    for (int i = 0; i < mReplay.eventCount(mFrame); ++i)
+    {
+        int event = mReplay.event(mFrame, i);
+        if (event > 0)
+        {
+            mGame->onEventStart(event);
+        }
+        else
+        {
+            mGame->onEventEnd(-event);
+        }
+    }
+    ++mFrame;
+}
+
+void PlatformReplay::renderGame()
+{
+}
+
+long PlatformReplay::getSystemTime()
+{
+    return mTime;
+}
+
+int PlatformReplay::random()
+{
+    return Replay::random(mRandomState);
+}
+
+void PlatformReplay::onLineCompleted()
+{
+}
+
+void PlatformReplay::onPieceDrop()
+{
+}
+}
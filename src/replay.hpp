@@ -0,0 +1,102 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Game replays.                                                            */
+/*   A replay stores the random seed and, for every game update, the time     */
+/*   returned by the platform and the input events in the order they were     */
+/*   sent. Playing it back with the same game rules gives the same game.      */
+/*                                                                            */
+/*   Replay files are text:                                                   */
+/*       STC-REPLAY 1                                                         */
+/*       seed <seed>                                                          */
+/*       time <time of the game start>                                        */
+/*       <time> [+event | -event]...       (one line per update)              */
+/*   where +event is an event start and -event an event end (Game::EVENT_*).  */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#ifndef STC_SRC_REPLAY_HPP_
+#define STC_SRC_REPLAY_HPP_
+
+#include "game.hpp"
+#include <vector>
+
+namespace stc
+{
+
+class Replay
+{
+public:
+    // Version of the replay files
+    static const int VERSION = 1;
+
+    Replay();
+
+    // Forget all the updates and start a new replay
+    void start(unsigned int seed, long time);
+
+    // Add a game update and the events sent in it
+    void addFrame(long time);
+    void addEvent(int event, bool start);
+
+    // Save or load a replay file, return false on error
+    bool save(const char *file) const;
+    bool load(const char *file);
+
+    unsigned int seed() const { return mSeed; }
+    long startTime() const    { return mStartTime; }
+    int frameCount() const    { return (int)mFrameTimes.size(); }
+    long frameTime(int frame) const { return mFrameTimes[frame]; }
+
+    // Events of an update, positive values are event starts
+    // and negative values are event ends
+    int eventCount(int frame) const;
+    int event(int frame, int index) const { return mEvents[mFirstEvents[frame] + index]; }
+
+    // Deterministic random number generator, return a random positive
+    // integer number and advance [state]
+    static int random(unsigned int &state);
+
+private:
+    unsigned int mSeed;
+    long mStartTime;
+    std::vector<long> mFrameTimes;
+    std::vector<int>  mFirstEvents;  // index in mEvents of the first event of every update
+    std::vector<int>  mEvents;
+};
+
+// Platform that plays a replay, it doesn't render anything.
+// The game quits when there are no more updates in the replay.
+class PlatformReplay : public Platform
+{
+public:
+    PlatformReplay(const Replay &replay);
+
+    virtual int init(Game *game);
+    virtual void end();
+    virtual void processEvents();
+    virtual void renderGame();
+    virtual long getSystemTime();
+    virtual int random();
+    virtual void onLineCompleted();
+    virtual void onPieceDrop();
+
+    // Return true if all the updates were played
+    bool isFinished() const { return mFrame >= mReplay.frameCount(); }
+
+    // Return the time of the next update
+    long nextTime() const   { return mReplay.frameTime(mFrame); }
+
+private:
+    const Replay &mReplay;
+    Game*         mGame;
+    int           mFrame;
+    long          mTime;
+    unsigned int  mRandomState;
+};
+}
+
+#endif // STC_SRC_REPLAY_HPP_
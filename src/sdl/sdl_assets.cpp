@@ -0,0 +1,36 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Access to the asset files for SDL.                                       */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "sdl_assets.hpp"
+
+namespace stc
+{
+
+// Pack in use, NULL if the asset files are used
+static const AssetPack *gPack = NULL;
+
+// Use the assets of [pack], NULL to use the asset files
+void AssetsSdl::usePack(const AssetPack *pack)
+{
+    gPack = pack;
+}
+
+// Open an asset by its file name, return NULL on error
+SDL_RWops* AssetsSdl::open(const char *file)
+{
+    const void *data;
+    size_t size;
+    if (gPack != NULL && gPack->find(file, &data, &size))
+    {
+        return SDL_RWFromConstMem(data, (int)size);
+    }
+    return SDL_RWFromFile(file, "rb");
+}
+}
@@ -0,0 +1,35 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Access to the asset files for SDL.                                       */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#ifndef STC_SDL_ASSETS_HPP_
+#define STC_SDL_ASSETS_HPP_
+
+#include "../pack.hpp"
+#include <SDL.h>
+
+namespace stc
+{
+
+// Opens the assets from the asset pack in use, or from the asset files if
+// there is no pack or the asset isn't in it. Assets in a pack are read
+// from its memory without copies.
+class AssetsSdl
+{
+public:
+    // Use the assets of [pack], NULL to use the asset files. Call it before
+    // loading anything, the pack must stay open while its assets are used.
+    static void usePack(const AssetPack *pack);
+
+    // Open an asset by its file name, return NULL on error
+    static SDL_RWops* open(const char *file);
+};
+}
+
+#endif // STC_SDL_ASSETS_HPP_
@@ -0,0 +1,312 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   SDL_mixer audio output with an optional low latency mode.                */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "sdl_audio.hpp"
+#include <cstdio>
+
+namespace stc
+{
+
+// Duration of the check window of the underruns (in milliseconds)
+static const long UNDERRUN_WINDOW = 1000;
+
+//------------------------------------------------------------------------------
+// Sound queue
+
+SoundQueue::SoundQueue()
+{
+    mHead = 0;
+    mTail = 0;
+}
+
+// Add a sound, return false if the queue is full
+bool SoundQueue::push(int sound)
+{
+    unsigned int head = mHead;
+    if (head - mTail == CAPACITY)
+    {
+        return false;
+    }
+    mSounds[head & (CAPACITY - 1)] = (Uint8)sound;
+
+    // The command must be written before it's published
+    STC_MEMORY_BARRIER();
+    mHead = head + 1;
+    return true;
+}
+
+// Remove the oldest sound, return -1 if the queue is empty
+int SoundQueue::pop()
+{
+    unsigned int tail = mTail;
+    if (tail == mHead)
+    {
+        return -1;
+    }
+    STC_MEMORY_BARRIER();
+    int sound = mSounds[tail & (CAPACITY - 1)];
+
+    // The command must be read before its slot is released
+    STC_MEMORY_BARRIER();
+    mTail = tail + 1;
+    return sound;
+}
+
+//------------------------------------------------------------------------------
+// Audio output
+
+AudioSdl::AudioSdl()
+{
+    mLowLatency = false;
+    mBufferSamples = DEFAULT_BUFFER;
+    mMusic = NULL;
+    for (int i = 0; i < SOUND_COUNT; ++i)
+    {
+        mSounds[i] = NULL;
+    }
+}
+
+// Start in low latency mode with a buffer of [samples], call it before open
+void AudioSdl::setLowLatency(int samples)
+{
+    mLowLatency = true;
+    mBufferSamples = (samples < MIN_BUFFER)? MIN_BUFFER : (samples > MAX_BUFFER)? MAX_BUFFER : samples;
+}
+
+// Open the audio device, load the sounds and play the music
+bool AudioSdl::open()
+{
+    mPeriodSamples = 0;
+    mUnderruns = 0;
+    mPlayTime = 0;
+    mRequestTime = 0;
+    mLatencySum = 0;
+    mLatencyMax = 0;
+    mLatencyCount = 0;
+    mBackOffs = 0;
+    mCheckedUnderruns = 0;
+    mCheckTime = SDL_GetTicks();
+
+    if (openDevice() != 0)
+    {
+        return false;
+    }
+
+    // Load the music file and sound effects in the background, the game
+    // starts without them
+#if (SDL_MIXER_MINOR_VERSION > 2) || (SDL_MIXER_PATCHLEVEL >= 10)
+    Mix_Init(MIX_INIT_OGG);
+#endif
+    mLoadMusic.start(loadMusic, STC_SND_MUSIC);
+    mLoadSounds[SOUND_LINE].start(loadSound, STC_SND_LINE);
+    mLoadSounds[SOUND_DROP].start(loadSound, STC_SND_DROP);
+    return true;
+}
+
+// Load the music, used by the loading threads
+void *AudioSdl::loadMusic(const char *file)
+{
+#if (SDL_MIXER_MINOR_VERSION > 2) || (SDL_MIXER_PATCHLEVEL >= 12)
+    return Mix_LoadMUSType_RW(AssetsSdl::open(file), MUS_NONE, 1);
+#else
+    return Mix_LoadMUS(file);
+#endif
+}
+
+// Load a sound effect, used by the loading threads
+void *AudioSdl::loadSound(const char *file)
+{
+    return Mix_LoadWAV_RW(AssetsSdl::open(file), 1);
+}
+
+// Take the music and sounds loaded since the last frame
+void AudioSdl::updateLoads()
+{
+    if (mLoadMusic.isDone())
+    {
+        mMusic = (Mix_Music *)mLoadMusic.take();
+
+        // Play the music in a loop
+        Mix_PlayMusic(mMusic, -1);
+    }
+    for (int i = 0; i < SOUND_COUNT; ++i)
+    {
+        if (mLoadSounds[i].isDone())
+        {
+            mSounds[i] = (Mix_Chunk *)mLoadSounds[i].take();
+        }
+    }
+}
+
+// Return true if a loading thread may still be using the mixer
+bool AudioSdl::loadsPending() const
+{
+    for (int i = 0; i < SOUND_COUNT; ++i)
+    {
+        if (mLoadSounds[i].isPending())
+        {
+            return true;
+        }
+    }
+    return mLoadMusic.isPending();
+}
+
+// Open SDL_mixer with the current buffer size
+int AudioSdl::openDevice()
+{
+    // 16-bit stereo
+    if (Mix_OpenAudio(AUDIO_RATE, AUDIO_S16, AUDIO_CHANNELS, mBufferSamples) != 0)
+    {
+        return -1;
+    }
+    mLastMixTime = 0;
+    Mix_SetPostMix(onMixed, this);
+    return 0;
+}
+
+void AudioSdl::closeDevice()
+{
+    Mix_SetPostMix(NULL, NULL);
+    Mix_CloseAudio();
+}
+
+// Called by the mixer after mixing every buffer, in the audio thread
+void AudioSdl::onMixed(void *udata, Uint8 *stream, int len)
+{
+    (void)stream;
+    STC_TRACE_THREAD("audio");
+    STC_TRACE_SPAN("mixed");
+    AudioSdl *audio = (AudioSdl *)udata;
+    Uint32 now = SDL_GetTicks();
+
+    // 16-bit samples
+    int samples = len / (2 * AUDIO_CHANNELS);
+    Uint32 period = (Uint32)(samples * 1000 / AUDIO_RATE);
+    audio->mPeriodSamples = samples;
+
+    // The device asked for samples too late, it was playing silence
+    if (audio->mLastMixTime != 0 && now - audio->mLastMixTime > UNDERRUN_PERIODS * period)
+    {
+        audio->mUnderruns = audio->mUnderruns + 1;
+    }
+    audio->mLastMixTime = now;
+
+    // The requested sound was mixed now, it's heard after this buffer is played
+    Uint32 requested = audio->mPlayTime;
+    if (requested != 0)
+    {
+        Uint32 latency = now - requested + period;
+        audio->mLatencySum = audio->mLatencySum + latency;
+        if (latency > audio->mLatencyMax)
+        {
+            audio->mLatencyMax = latency;
+        }
+        audio->mLatencyCount = audio->mLatencyCount + 1;
+        audio->mPlayTime = 0;
+    }
+}
+
+// Check the underruns and grow the buffer if they are too many
+void AudioSdl::update(long time)
+{
+    updateLoads();
+    if (!mLowLatency || mBufferSamples >= MAX_BUFFER)
+    {
+        return;
+    }
+    int underruns = mUnderruns;
+    if (underruns - mCheckedUnderruns >= UNDERRUN_LIMIT)
+    {
+        // The loading threads decode with the mixer format, so the device
+        // is reopened after they finish and their results are taken
+        if (loadsPending())
+        {
+            return;
+        }
+
+        // Reopen the device with a bigger buffer, the format doesn't
+        // change so the loaded sounds are still valid
+        closeDevice();
+        mBufferSamples *= 2;
+        if (openDevice() != 0)
+        {
+            mLowLatency = false;
+            return;
+        }
+        Mix_PlayMusic(mMusic, -1);
+        ++mBackOffs;
+        mCheckedUnderruns = mUnderruns;
+        mCheckTime = time;
+    }
+    else if (time - mCheckTime >= UNDERRUN_WINDOW)
+    {
+        mCheckedUnderruns = underruns;
+        mCheckTime = time;
+    }
+}
+
+// Queue a sound effect
+void AudioSdl::play(int sound)
+{
+    if (mQueue.push(sound) && mLowLatency && mRequestTime == 0)
+    {
+        Uint32 now = SDL_GetTicks();
+        mRequestTime = (now != 0)? now : 1;
+    }
+}
+
+// Give the queued sound effects to the mixer, the ones not loaded yet are skipped
+void AudioSdl::flush()
+{
+    int sound;
+    while ((sound = mQueue.pop()) >= 0)
+    {
+        if (mSounds[sound] != NULL)
+        {
+            Mix_PlayChannel(-1, mSounds[sound], 0);
+        }
+    }
+
+    // The mixer callback measures the latency from the request
+    if (mRequestTime != 0)
+    {
+        if (mPlayTime == 0)
+        {
+            mPlayTime = mRequestTime;
+        }
+        mRequestTime = 0;
+    }
+}
+
+// Close the audio device and free the sounds
+void AudioSdl::close()
+{
+    if (mLowLatency)
+    {
+        int count = mLatencyCount;
+        fprintf(stderr, "audio: buffer %d samples (%d ms), latency %d ms average, %d ms max, "
+                "%d underruns, %d back offs\n",
+                mPeriodSamples, mPeriodSamples * 1000 / AUDIO_RATE,
+                (count > 0)? (int)(mLatencySum / count) : 0, (int)mLatencyMax,
+                (int)mUnderruns, mBackOffs);
+    }
+    Mix_HaltMusic();
+    Mix_FreeMusic(mMusic);
+    Mix_FreeMusic((Mix_Music *)mLoadMusic.take());
+    for (int i = 0; i < SOUND_COUNT; ++i)
+    {
+        Mix_FreeChunk(mSounds[i]);
+        Mix_FreeChunk((Mix_Chunk *)mLoadSounds[i].take());
+        mSounds[i] = NULL;
+    }
+    mMusic = NULL;
+    closeDevice();
+}
+}
@@ -0,0 +1,152 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Constants and definitions for the SDL_mixer audio output.                */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#ifndef STC_SDL_AUDIO_HPP_
+#define STC_SDL_AUDIO_HPP_
+
+#include <SDL.h>
+#include <SDL_mixer.h>
+#include "sdl_loader.hpp"
+#include "sdl_assets.hpp"
+
+// Memory barrier between the writes of the queued data and its index
+#if defined(__GNUC__)
+#define STC_MEMORY_BARRIER() __sync_synchronize()
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define STC_MEMORY_BARRIER() _ReadWriteBarrier()
+#endif
+
+namespace stc
+{
+
+// Sound files
+#define STC_SND_MUSIC           "assets/stc_theme_loop.ogg"
+#define STC_SND_LINE            "assets/fx_line.wav"
+#define STC_SND_DROP            "assets/fx_drop.wav"
+
+// Queue of sound commands with a single producer and a single consumer.
+// Each index is only written by one side, so neither of them ever waits,
+// a sound pushed on a full queue is dropped.
+class SoundQueue
+{
+public:
+    // Number of commands (power of two)
+    static const unsigned int CAPACITY = 64;
+
+    SoundQueue();
+
+    // Add a sound, return false if the queue is full
+    bool push(int sound);
+
+    // Remove the oldest sound, return -1 if the queue is empty
+    int pop();
+
+private:
+    Uint8 mSounds[CAPACITY];
+    volatile unsigned int mHead;  // next command to write, written by the producer
+    volatile unsigned int mTail;  // next command to read, written by the consumer
+};
+
+// Music and sound effects played with SDL_mixer.
+// Sounds requested by the game are queued and given to the mixer at the
+// end of the frame, so the game never waits for the audio lock.
+// The mixer buffer is 4096 samples by default (93 ms). In low latency mode
+// it starts smaller and it is doubled every time the audio device runs out
+// of samples too often, the latency and the underruns are measured.
+class AudioSdl
+{
+public:
+    // Sound effects
+    enum
+    {
+        SOUND_LINE,
+        SOUND_DROP,
+        SOUND_COUNT
+    };
+
+    // Output format
+    static const int AUDIO_RATE     = 44100;
+    static const int AUDIO_CHANNELS = 2;
+
+    // Mixer buffer sizes (in samples)
+    static const int DEFAULT_BUFFER = 4096;
+    static const int MIN_BUFFER     = 256;
+    static const int MAX_BUFFER     = 4096;
+
+    // A mixer callback coming later than this number of buffer periods
+    // after the previous one means the device ran out of samples
+    static const int UNDERRUN_PERIODS = 2;
+
+    // Underruns in a second that make the low latency mode grow the buffer
+    static const int UNDERRUN_LIMIT = 2;
+
+    AudioSdl();
+
+    // Start in low latency mode with a buffer of [samples], call it before open
+    void setLowLatency(int samples);
+
+    // Open the audio device and start loading the sounds and the music in
+    // worker threads, return false if the device can't be opened
+    bool open();
+
+    // Play the music once it's loaded, check the underruns and grow the
+    // buffer if needed, call it once per frame
+    void update(long time);
+
+    // Queue a sound effect, it never waits for the mixer
+    void play(int sound);
+
+    // Play the queued sound effects, call it at the end of every frame
+    void flush();
+
+    // Close the audio device and print the measures in low latency mode
+    void close();
+
+private:
+
+    bool mLowLatency;
+    int  mBufferSamples;  // requested mixer buffer size
+
+    // Music and sounds, they are NULL until they are loaded
+    Mix_Music *mMusic;
+    Mix_Chunk *mSounds[SOUND_COUNT];
+    AsyncLoad  mLoadMusic;
+    AsyncLoad  mLoadSounds[SOUND_COUNT];
+
+    // Sounds requested by the game and not yet given to the mixer
+    SoundQueue mQueue;
+    Uint32     mRequestTime;  // time of the first queued sound (0 if none)
+
+    // Measures, written by the mixer callback and read by the game thread.
+    // Readers may see stale values, which only delays the back off.
+    volatile Uint32 mLastMixTime;     // time of the last mixer callback
+    volatile int    mPeriodSamples;   // samples mixed per callback
+    volatile int    mUnderruns;
+    volatile Uint32 mPlayTime;        // time of the last sound request (0 if mixed)
+    volatile Uint32 mLatencySum;      // output latency of the mixed requests
+    volatile Uint32 mLatencyMax;
+    volatile int    mLatencyCount;
+
+    int  mBackOffs;            // times the buffer was grown
+    int  mCheckedUnderruns;    // underruns when the last check window started
+    long mCheckTime;           // time when the last check window started
+
+    int  openDevice();
+    void closeDevice();
+    void updateLoads();
+    bool loadsPending() const;
+    static void *loadMusic(const char *file);
+    static void *loadSound(const char *file);
+    static void onMixed(void *udata, Uint8 *stream, int len);
+};
+}
+
+#endif // STC_SDL_AUDIO_HPP_
@@ -17,18 +17,105 @@
 namespace stc
 {
 
+#ifdef STC_EMBED_ASSETS
+// Asset pack built into the program (see tools/pack_build.cpp)
+extern const unsigned char stcAssetPack[];
+extern const unsigned long stcAssetPackSize;
+#endif
+
+PlatformSdl::PlatformSdl()
+{
+    mReplayFile = NULL;
+    mSharedName = NULL;
+    mBenchmark = false;
+    mBlitCount = 0;
+
+    // Nothing is created yet, end() can run after a failed init
+    mScreen = NULL;
+    mBmpTiles = NULL;
+    mBmpBack = NULL;
+    mBmpNumbers = NULL;
+    mBoardLayer = NULL;
+}
+
+// Record the game in a replay file, call it before starting the game
+void PlatformSdl::recordReplay(const char *file)
+{
+    mReplayFile = file;
+}
+
+// Use a small mixer buffer of [samples], call it before starting the game
+void PlatformSdl::setLowLatencyAudio(int samples)
+{
+    mAudio.setLowLatency(samples);
+}
+
+// Share the game state with a bot, call it before starting the game
+void PlatformSdl::setSharedState(const char *name)
+{
+    mSharedName = name;
+}
+
+// Run without audio and without resting, call it before starting the game
+void PlatformSdl::setBenchmark(bool benchmark)
+{
+    mBenchmark = benchmark;
+}
+
 // Initializes platform, if there are no problems returns ERROR_NONE.
 int PlatformSdl::init(Game *game)
 {
-    // Initialize the random number generator
-    srand((unsigned int)(time(NULL)));
+    mGame = game;
 
     // Start video and audio system
-    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO) < 0)
+    if (SDL_Init(SDL_INIT_VIDEO | (mBenchmark? 0 : SDL_INIT_AUDIO)) < 0)
+    {
+        return Game::ERROR_PLATFORM;
+    }
+
+    // Load the assets from the pack if there is one
+#ifdef STC_EMBED_ASSETS
+    mPack.openMemory(stcAssetPack, stcAssetPackSize);
+#else
+    mPack.open(STC_ASSET_PACK);
+#endif
+    AssetsSdl::usePack(mPack.isOpen()? &mPack : NULL);
+
+    // Initialize the random number generator and the replay
+    unsigned int seed = (unsigned int)(time(NULL));
+    mRandomState = seed;
+    mFrameTime = SDL_GetTicks();
+    mReplay.start(seed, mFrameTime);
+
+    // Create the screen and load images
+    int error = initRenderer();
+    if (error != Game::ERROR_NONE)
+    {
+        return error;
+    }
+
+    // Create the segment shared with the bot
+    if (mSharedName != NULL && !mShared.create(mSharedName))
+    {
+        return Game::ERROR_PLATFORM;
+    }
+
+    // Set window caption
+    SDL_WM_SetCaption(STC_GAME_NAME " (C++)", STC_GAME_NAME);
+
+    // Open the audio device and play the music
+    if (!mBenchmark && !mAudio.open())
     {
         return Game::ERROR_PLATFORM;
     }
 
+    return Game::ERROR_NONE;
+}
+
+// Create the screen surface and load the images, if there are no problems
+// returns ERROR_NONE.
+int PlatformSdl::initRenderer()
+{
     // Create game video surface
     mScreen = SDL_SetVideoMode(SCREEN_WIDTH, SCREEN_HEIGHT,
                               SCREEN_BIT_DEPTH,
@@ -38,54 +125,160 @@ int PlatformSdl::init(Game *game)
         return Game::ERROR_NO_VIDEO;
     }
 
-    // Set window caption
-    SDL_WM_SetCaption(STC_GAME_NAME " (C++)", STC_GAME_NAME);
-
-    // Load images for blocks and background
-    mBmpTiles = IMG_Load(STC_BMP_TILE_BLOCKS);
-    mBmpBack = IMG_Load(STC_BMP_BACKGROUND);
-    mBmpNumbers = IMG_Load(STC_BMP_NUMBERS);
+    // Decode the background and the numbers in worker threads while the
+    // tiles are decoded here, the first frame is shown without them
+#if (SDL_IMAGE_MINOR_VERSION > 2) || (SDL_IMAGE_PATCHLEVEL >= 10)
+    IMG_Init(IMG_INIT_PNG);
+#endif
+    mBmpBack = NULL;
+    mBmpNumbers = NULL;
+    mLoadBack.start(decodeImage, STC_BMP_BACKGROUND);
+    mLoadNumbers.start(decodeImage, STC_BMP_NUMBERS);
 
-    if (mBmpTiles == NULL || mBmpBack == NULL || mBmpNumbers == NULL)
+    mBmpTiles = loadImage(STC_BMP_TILE_BLOCKS, false);
+    if (mBmpTiles == NULL)
     {
         return Game::ERROR_NO_IMAGES;
     }
 
-	// Setup audio
-	int audioRate = 44100;
-	Uint16 audioFormat = AUDIO_S16; // 16-bit stereo
-	int audioChannels = 2;
-	int audioBuffers = 4096;
+    // Create the locked board layer with the screen format
+    mBoardLayer = SDL_CreateRGBSurface(SDL_SWSURFACE,
+                                       TILE_SIZE * Game::BOARD_TILEMAP_WIDTH + 1,
+                                       TILE_SIZE * Game::BOARD_TILEMAP_HEIGHT + 1,
+                                       mScreen->format->BitsPerPixel,
+                                       mScreen->format->Rmask,
+                                       mScreen->format->Gmask,
+                                       mScreen->format->Bmask,
+                                       mScreen->format->Amask);
+    if (mBoardLayer == NULL)
+    {
+        return Game::ERROR_NO_MEMORY;
+    }
 
-	// Open SDL_mixer
-	if (Mix_OpenAudio(audioRate, audioFormat, audioChannels, audioBuffers))
-	{
-        return Game::ERROR_PLATFORM;
-	}
+    // Nothing has been shown yet, the first frame redraws everything
+    mDirtyCount = 0;
+    mFullRedraw = true;
+    mBlitCount = 0;
+
+    // Setup statistic counters
+    setCounter(COUNTER_LEVEL, LEVEL_X, LEVEL_Y, LEVEL_LENGTH, Game::COLOR_WHITE);
+    setCounter(COUNTER_LINES, LINES_X, LINES_Y, LINES_LENGTH, Game::COLOR_WHITE);
+    setCounter(COUNTER_SCORE, SCORE_X, SCORE_Y, SCORE_LENGTH, Game::COLOR_WHITE);
+    setCounter(COUNTER_TOTAL_PIECES, PIECES_X, PIECES_Y, PIECES_LENGTH, Game::COLOR_WHITE);
+    setCounter(COUNTER_PIECES + Game::TETROMINO_L, TETROMINO_X, TETROMINO_L_Y, TETROMINO_LENGTH, Game::COLOR_ORANGE);
+    setCounter(COUNTER_PIECES + Game::TETROMINO_I, TETROMINO_X, TETROMINO_I_Y, TETROMINO_LENGTH, Game::COLOR_CYAN);
+    setCounter(COUNTER_PIECES + Game::TETROMINO_T, TETROMINO_X, TETROMINO_T_Y, TETROMINO_LENGTH, Game::COLOR_PURPLE);
+    setCounter(COUNTER_PIECES + Game::TETROMINO_S, TETROMINO_X, TETROMINO_S_Y, TETROMINO_LENGTH, Game::COLOR_GREEN);
+    setCounter(COUNTER_PIECES + Game::TETROMINO_Z, TETROMINO_X, TETROMINO_Z_Y, TETROMINO_LENGTH, Game::COLOR_RED);
+    setCounter(COUNTER_PIECES + Game::TETROMINO_O, TETROMINO_X, TETROMINO_O_Y, TETROMINO_LENGTH, Game::COLOR_YELLOW);
+    setCounter(COUNTER_PIECES + Game::TETROMINO_J, TETROMINO_X, TETROMINO_J_Y, TETROMINO_LENGTH, Game::COLOR_BLUE);
+
+    // Benchmarks measure complete frames from the start
+    if (mBenchmark)
+    {
+        while (!mLoadBack.isDone() || !mLoadNumbers.isDone())
+        {
+            SDL_Delay(1);
+        }
+        updateImages();
+        if (mBmpBack == NULL || mBmpNumbers == NULL)
+        {
+            return Game::ERROR_NO_IMAGES;
+        }
+    }
+    return Game::ERROR_NONE;
+}
 
-	// Load the music file and sound effects
-	mMusic = Mix_LoadMUS(STC_SND_MUSIC);
-	mSoundLine = Mix_LoadWAV(STC_SND_LINE);
-	mSoundDrop = Mix_LoadWAV(STC_SND_DROP);
+// Load an image and convert it to the screen format, so blits don't need to
+// convert pixels every time. Transparent images are RLE encoded and opaque
+// images lose their alpha channel (if any). Return NULL on error.
+SDL_Surface* PlatformSdl::loadImage(const char *file, bool opaque)
+{
+    return convertImage(IMG_Load_RW(AssetsSdl::open(file), 1), opaque);
+}
 
-	// Play the music in a loop
-	Mix_PlayMusic(mMusic, -1);
+// Decode an image file, used by the loading threads
+void *PlatformSdl::decodeImage(const char *file)
+{
+    return IMG_Load_RW(AssetsSdl::open(file), 1);
+}
 
-    mGame = game;
-    return Game::ERROR_NONE;
+// Convert a decoded image to the screen format and free it
+SDL_Surface* PlatformSdl::convertImage(SDL_Surface *image, bool opaque)
+{
+    if (image == NULL)
+    {
+        return NULL;
+    }
+
+    SDL_Surface *converted;
+    if (opaque)
+    {
+        converted = SDL_DisplayFormat(image);
+    }
+    else if ((image->flags & SDL_SRCCOLORKEY) != 0)
+    {
+        converted = SDL_DisplayFormat(image);
+        if (converted != NULL)
+        {
+            SDL_SetColorKey(converted, SDL_SRCCOLORKEY | SDL_RLEACCEL,
+                            converted->format->colorkey);
+        }
+    }
+    else if (image->format->Amask != 0)
+    {
+        converted = SDL_DisplayFormatAlpha(image);
+        if (converted != NULL)
+        {
+            SDL_SetAlpha(converted, SDL_SRCALPHA | SDL_RLEACCEL, SDL_ALPHA_OPAQUE);
+        }
+    }
+    else
+    {
+        converted = SDL_DisplayFormat(image);
+    }
+    SDL_FreeSurface(image);
+    return converted;
 }
 
-// Return the current system time in milliseconds
+// Return the system time in milliseconds when the events were processed
 long PlatformSdl::getSystemTime()
 {
-    return SDL_GetTicks();
+    return mFrameTime;
+}
+
+// Notify an event to the game and record it
+void PlatformSdl::sendEvent(bool start, int event)
+{
+    if (mReplayFile != NULL)
+    {
+        mReplay.addEvent(event, start);
+    }
+    if (start)
+    {
+        mGame->onEventStart(event);
+    }
+    else
+    {
+        mGame->onEventEnd(event);
+    }
 }
 
-// Process events and notify game
+// Process events and notify game. The time of the game update is
+// taken here, so a replay can give the game the same times.
 void PlatformSdl::processEvents()
 {
     SDL_Event event;
 
+    mFrameTime = SDL_GetTicks();
+    if (mReplayFile != NULL)
+    {
+        mReplay.addFrame(mFrameTime);
+    }
+
+    // The audio may need a bigger buffer
+    mAudio.update(mFrameTime);
+
     // Grab events in the queue
     while (SDL_PollEvent(&event))
     {
@@ -93,46 +286,46 @@ void PlatformSdl::processEvents()
         {
         // On quit game
         case SDL_QUIT:
-            mGame->onEventStart(Game::EVENT_QUIT);
+            sendEvent(true, Game::EVENT_QUIT);
             break;
         // On key pressed
         case SDL_KEYDOWN:
             switch (event.key.keysym.sym)
             {
             case SDLK_ESCAPE:
-                mGame->onEventStart(Game::EVENT_QUIT);
+                sendEvent(true, Game::EVENT_QUIT);
                 break;
             case SDLK_s:
             case SDLK_DOWN:
-                mGame->onEventStart(Game::EVENT_MOVE_DOWN);
+                sendEvent(true, Game::EVENT_MOVE_DOWN);
                 break;
             case SDLK_w:
             case SDLK_UP:
-                mGame->onEventStart(Game::EVENT_ROTATE_CW);
+                sendEvent(true, Game::EVENT_ROTATE_CW);
                 break;
             case SDLK_a:
             case SDLK_LEFT:
-                mGame->onEventStart(Game::EVENT_MOVE_LEFT);
+                sendEvent(true, Game::EVENT_MOVE_LEFT);
                 break;
             case SDLK_d:
             case SDLK_RIGHT:
-                mGame->onEventStart(Game::EVENT_MOVE_RIGHT);
+                sendEvent(true, Game::EVENT_MOVE_RIGHT);
                 break;
             case SDLK_SPACE:
-                mGame->onEventStart(Game::EVENT_DROP);
+                sendEvent(true, Game::EVENT_DROP);
                 break;
             case SDLK_F5:
-                mGame->onEventStart(Game::EVENT_RESTART);
+                sendEvent(true, Game::EVENT_RESTART);
                 break;
             case SDLK_F1:
-                mGame->onEventStart(Game::EVENT_PAUSE);
+                sendEvent(true, Game::EVENT_PAUSE);
                 break;
             case SDLK_F2:
-                mGame->onEventStart(Game::EVENT_SHOW_NEXT);
+                sendEvent(true, Game::EVENT_SHOW_NEXT);
                 break;
 #ifdef STC_SHOW_GHOST_PIECE
             case SDLK_F3:
-                mGame->onEventStart(Game::EVENT_SHOW_SHADOW);
+                sendEvent(true, Game::EVENT_SHOW_SHADOW);
                 break;
 #endif // STC_SHOW_GHOST_PIECE
             default:
@@ -145,20 +338,20 @@ void PlatformSdl::processEvents()
             {
             case SDLK_s:
             case SDLK_DOWN:
-                mGame->onEventEnd(Game::EVENT_MOVE_DOWN);
+                sendEvent(false, Game::EVENT_MOVE_DOWN);
                 break;
             case SDLK_a:
             case SDLK_LEFT:
-                mGame->onEventEnd(Game::EVENT_MOVE_LEFT);
+                sendEvent(false, Game::EVENT_MOVE_LEFT);
                 break;
             case SDLK_d:
             case SDLK_RIGHT:
-                mGame->onEventEnd(Game::EVENT_MOVE_RIGHT);
+                sendEvent(false, Game::EVENT_MOVE_RIGHT);
                 break;
 #ifdef STC_AUTO_ROTATION
             case SDLK_w:
             case SDLK_UP:
-                mGame->onEventEnd(Game::EVENT_ROTATE_CW);
+                sendEvent(false, Game::EVENT_ROTATE_CW);
                 break;
 #endif // STC_AUTO_ROTATION
             default:
@@ -168,11 +361,32 @@ void PlatformSdl::processEvents()
             break;
         }
     }
+
+    // Key presses of the bot, recorded like the ones of the keyboard
+    bool press;
+    int key;
+    while (mShared.popInput(&press, &key))
+    {
+        sendEvent(press, key);
+    }
 }
 
-// Draw a tile from a tetromino
+// Blit a surface and count it
+void PlatformSdl::blit(SDL_Surface *source, SDL_Rect *sourceRect, SDL_Surface *target, SDL_Rect *targetRect)
+{
+    ++mBlitCount;
+    SDL_BlitSurface(source, sourceRect, target, targetRect);
+}
+
+// Draw a tile from a tetromino, tiles outside of the repainted region are skipped
 void PlatformSdl::drawTile(int x, int y, int tile, bool shadow)
 {
+    if ((x >= mClip.x + mClip.w) || (x + TILE_SIZE + 1 <= mClip.x)
+            || (y >= mClip.y + mClip.h) || (y + TILE_SIZE + 1 <= mClip.y))
+    {
+        return;
+    }
+
     SDL_Rect recDestine;
     SDL_Rect recSource;
 
@@ -182,159 +396,532 @@ void PlatformSdl::drawTile(int x, int y, int tile, bool shadow)
     recSource.y = (TILE_SIZE + 1) * (shadow? 1 : 0);
     recSource.w = TILE_SIZE + 1;
     recSource.h = TILE_SIZE + 1;
-    SDL_BlitSurface(mBmpTiles, &recSource, mScreen, &recDestine);
+    blit(mBmpTiles, &recSource, mScreen, &recDestine);
 }
 
-// Draw a number on the given position
-void PlatformSdl::drawNumber(int x, int y, long number, int length, int color)
+// Draw the cached digits of a counter, digits outside of the repainted region are skipped
+void PlatformSdl::drawCounter(const StcCounter &counter)
 {
+    if ((mBmpNumbers == NULL)
+            || (counter.y >= mClip.y + mClip.h) || (counter.y + NUMBER_HEIGHT <= mClip.y))
+    {
+        return;
+    }
+
     SDL_Rect recDestine;
     SDL_Rect recSource;
 
-    recSource.y = (Sint16)(NUMBER_HEIGHT * color);
+    recSource.y = (Sint16)(NUMBER_HEIGHT * counter.color);
     recSource.w = NUMBER_WIDTH;
     recSource.h = NUMBER_HEIGHT;
-    recDestine.y = (Sint16)y;
+    recDestine.y = (Sint16)counter.y;
 
-    int pos = 0;
-    do
+    for (int pos = 0; pos < counter.length; ++pos)
     {
-        recDestine.x = (Sint16)(x + NUMBER_WIDTH * (length - pos));
-        recSource.x = NUMBER_WIDTH * (Sint16)(number % 10);
-        SDL_BlitSurface(mBmpNumbers, &recSource, mScreen, &recDestine);
-        number /= 10;
-    } while (++pos < length);
+        int x = counter.x + NUMBER_WIDTH * (counter.length - pos);
+        if ((x < mClip.x + mClip.w) && (x + NUMBER_WIDTH > mClip.x))
+        {
+            recDestine.x = (Sint16)x;
+            recSource.x = (Sint16)(NUMBER_WIDTH * counter.digits[pos]);
+            blit(mBmpNumbers, &recSource, mScreen, &recDestine);
+        }
+    }
 }
 
-// Render the state of the game using platform functions
-void PlatformSdl::renderGame()
+// Set the position, length and color of a counter
+void PlatformSdl::setCounter(int counter, int x, int y, int length, int color)
 {
-    int i, j;
+    mCounters[counter].x = x;
+    mCounters[counter].y = y;
+    mCounters[counter].length = length;
+    mCounters[counter].color = color;
+    mCounters[counter].value = 0;
+    for (int pos = 0; pos < NUMBER_MAX_LENGTH; ++pos)
+    {
+        mCounters[counter].digits[pos] = 0;
+    }
+}
 
-    // Check if the game state has changed, if so redraw
-    if (mGame->hasChanged())
+// Update the cached digits of a counter. If [redraw] is true the region
+// of the changed digits is added to the damaged regions.
+void PlatformSdl::updateCounter(int counter, long value, bool redraw)
+{
+    StcCounter &target = mCounters[counter];
+    if (target.value == value)
     {
-        // Draw background
-        SDL_BlitSurface(mBmpBack, NULL, mScreen, NULL);
+        return;
+    }
+    target.value = value;
 
-        // Draw preview block
-        if (mGame->showPreview())
+    int first = -1;
+    int last = -1;
+    for (int pos = 0; pos < target.length; ++pos)
+    {
+        int digit = (int)(value % 10);
+        value /= 10;
+        if (digit != target.digits[pos])
         {
-            for (i = 0; i < Game::TETROMINO_SIZE; ++i)
-            {
-                for (j = 0; j < Game::TETROMINO_SIZE; ++j)
-                {
-                    if (mGame->nextBlock().cells[i][j] != Game::EMPTY_CELL)
-                    {
-                        drawTile(PREVIEW_X + (TILE_SIZE * i),
-                                 PREVIEW_Y + (TILE_SIZE * j),
-                                 mGame->nextBlock().cells[i][j], false);
-                    }
-                }
-            }
+            target.digits[pos] = digit;
+            if (first < 0) first = pos;
+            last = pos;
         }
-#ifdef STC_SHOW_GHOST_PIECE
-        // Draw shadow tetromino
-        if (mGame->showShadow() && mGame->shadowGap() > 0)
+    }
+
+    // Digits are drawn from right to left
+    if (redraw && (first >= 0))
+    {
+        addDirtyRect(target.x + NUMBER_WIDTH * (target.length - last), target.y,
+                     NUMBER_WIDTH * (last - first + 1), NUMBER_HEIGHT);
+    }
+}
+
+// Draw the cells of a tetromino with its up-left corner on the given position
+void PlatformSdl::drawTetromino(int x, int y, const Game::StcTetromino &block, bool shadow)
+{
+    for (int i = 0; i < Game::TETROMINO_SIZE; ++i)
+    {
+        for (int j = 0; j < Game::TETROMINO_SIZE; ++j)
         {
-            for (i = 0; i < Game::TETROMINO_SIZE; ++i)
+            if (block.cells[i][j] != Game::EMPTY_CELL)
             {
-                for (j = 0; j < Game::TETROMINO_SIZE; ++j)
-                {
-                    if (mGame->fallingBlock().cells[i][j] != Game::EMPTY_CELL)
-                    {
-                        drawTile(BOARD_X + (TILE_SIZE * (mGame->fallingBlock().x + i)),
-                                 BOARD_Y + (TILE_SIZE * (mGame->fallingBlock().y + mGame->shadowGap() + j)),
-                                 mGame->fallingBlock().cells[i][j], true);
-                    }
-                }
+                drawTile(x + (TILE_SIZE * i), y + (TILE_SIZE * j), block.cells[i][j], shadow);
             }
         }
-#endif
-        // Draw the cells in the board
-        for (i = 0; i < Game::BOARD_TILEMAP_WIDTH; ++i)
+    }
+}
+
+// Redraw the locked cells inside an area of the board layer (in tiles)
+// and add the area to the damaged regions of the screen
+void PlatformSdl::updateBoardLayer(int column, int row, int width, int height)
+{
+    // Tiles are one pixel bigger than the tile size and overlap the next ones
+    SDL_Rect clip;
+    clip.x = (Sint16)(TILE_SIZE * column);
+    clip.y = (Sint16)(TILE_SIZE * row);
+    clip.w = (Uint16)(TILE_SIZE * width + 1);
+    clip.h = (Uint16)(TILE_SIZE * height + 1);
+    SDL_SetClipRect(mBoardLayer, &clip);
+
+    SDL_Rect recSource = clip;
+    SDL_Rect recDestine = clip;
+    recSource.x += BOARD_X;
+    recSource.y += BOARD_Y;
+    if (mBmpBack != NULL)
+    {
+        blit(mBmpBack, &recSource, mBoardLayer, &recDestine);
+    }
+    else
+    {
+        SDL_FillRect(mBoardLayer, &recDestine, 0);
+    }
+
+    int firstColumn = (column > 0)? column - 1 : 0;
+    int firstRow = (row > 0)? row - 1 : 0;
+    int lastColumn = (column + width < Game::BOARD_TILEMAP_WIDTH)? column + width : column + width - 1;
+    int lastRow = (row + height < Game::BOARD_TILEMAP_HEIGHT)? row + height : row + height - 1;
+
+    recSource.y = 0;
+    recSource.w = TILE_SIZE + 1;
+    recSource.h = TILE_SIZE + 1;
+    for (int i = firstColumn; i <= lastColumn; ++i)
+    {
+        for (int j = firstRow; j <= lastRow; ++j)
         {
-            for (j = 0; j < Game::BOARD_TILEMAP_HEIGHT; ++j)
+            if (mGame->getCell(i, j) != Game::EMPTY_CELL)
             {
-                if (mGame->getCell(i, j) != Game::EMPTY_CELL)
-                {
-                    drawTile(BOARD_X + (TILE_SIZE * i),
-                             BOARD_Y + (TILE_SIZE * j),
-                             mGame->getCell(i, j), false);
-                }
+                recSource.x = (Sint16)(TILE_SIZE * mGame->getCell(i, j));
+                recDestine.x = (Sint16)(TILE_SIZE * i);
+                recDestine.y = (Sint16)(TILE_SIZE * j);
+                blit(mBmpTiles, &recSource, mBoardLayer, &recDestine);
             }
         }
+    }
+    SDL_SetClipRect(mBoardLayer, NULL);
 
-        // Draw falling tetromino
-        for (i = 0; i < Game::TETROMINO_SIZE; ++i)
+    addDirtyRect(BOARD_X + clip.x, BOARD_Y + clip.y, clip.w, clip.h);
+}
+
+// Add a region of the screen that must be redrawn in this frame
+void PlatformSdl::addDirtyRect(int x, int y, int w, int h)
+{
+    if (mDirtyCount == MAX_DIRTY_RECTS)
+    {
+        // Too many regions, just redraw everything
+        mFullRedraw = true;
+        return;
+    }
+    SDL_Rect *rect = &mDirtyRects[mDirtyCount++];
+    rect->x = (Sint16)x;
+    rect->y = (Sint16)y;
+    rect->w = (Uint16)w;
+    rect->h = (Uint16)h;
+}
+
+// Add the region covered by the cells of a tetromino drawn on the given position
+void PlatformSdl::addDirtyTetromino(int x, int y, const Game::StcTetromino &block)
+{
+    int left = Game::TETROMINO_SIZE;
+    int top = Game::TETROMINO_SIZE;
+    int right = -1;
+    int bottom = -1;
+
+    for (int i = 0; i < Game::TETROMINO_SIZE; ++i)
+    {
+        for (int j = 0; j < Game::TETROMINO_SIZE; ++j)
         {
-            for (j = 0; j < Game::TETROMINO_SIZE; ++j)
+            if (block.cells[i][j] != Game::EMPTY_CELL)
             {
-                if (mGame->fallingBlock().cells[i][j] != Game::EMPTY_CELL)
-                {
-                    drawTile(BOARD_X + (TILE_SIZE * (mGame->fallingBlock().x + i)),
-                             BOARD_Y + (TILE_SIZE * (mGame->fallingBlock().y + j)),
-                             mGame->fallingBlock().cells[i][j], false);
-                }
+                if (i < left)   left = i;
+                if (i > right)  right = i;
+                if (j < top)    top = j;
+                if (j > bottom) bottom = j;
             }
         }
+    }
+    if (right >= 0)
+    {
+        // Tiles are one pixel bigger than the tile size
+        addDirtyRect(x + TILE_SIZE * left, y + TILE_SIZE * top,
+                     TILE_SIZE * (right - left + 1) + 1,
+                     TILE_SIZE * (bottom - top + 1) + 1);
+    }
+}
+
+// Store the screen regions that must be redrawn for the changes of the game state
+void PlatformSdl::findDamage()
+{
+    const Game::StcChangeSet &changes = mGame->changes();
+
+    // The game was started, redraw everything
+    if ((changes.flags & Game::CHANGE_ALL) != 0)
+    {
+        updateBoardLayer(0, 0, Game::BOARD_TILEMAP_WIDTH, Game::BOARD_TILEMAP_HEIGHT);
+        updateStats(~0u, false);
+        mFullRedraw = true;
+        return;
+    }
+
+    // Cleared rows move every row above them
+    if ((changes.flags & Game::CHANGE_ROWS) != 0)
+    {
+        int bottom = Game::BOARD_TILEMAP_HEIGHT - 1;
+        while ((changes.clearedRows & (1u << bottom)) == 0)
+        {
+            --bottom;
+        }
+        // Locked cells below the cleared rows are not moved but are new
+        if ((changes.flags & Game::CHANGE_LOCKED) != 0 && changes.lockedBottom > bottom)
+        {
+            bottom = changes.lockedBottom;
+        }
+        updateBoardLayer(0, 0, Game::BOARD_TILEMAP_WIDTH, bottom + 1);
+    }
+    else if ((changes.flags & Game::CHANGE_LOCKED) != 0)
+    {
+        updateBoardLayer(changes.lockedLeft, changes.lockedTop,
+                         changes.lockedRight - changes.lockedLeft + 1,
+                         changes.lockedBottom - changes.lockedTop + 1);
+    }
+
+    // Falling tetromino
+    const Game::StcTetromino &block = mGame->fallingBlock();
+    if ((changes.flags & Game::CHANGE_FALLING) != 0)
+    {
+        addDirtyTetromino(BOARD_X + TILE_SIZE * changes.fromBlock.x,
+                          BOARD_Y + TILE_SIZE * changes.fromBlock.y, changes.fromBlock);
+        addDirtyTetromino(BOARD_X + TILE_SIZE * block.x,
+                          BOARD_Y + TILE_SIZE * block.y, block);
+    }
+#ifdef STC_SHOW_GHOST_PIECE
+    // Shadow tetromino, it moves with the falling tetromino and the board
+    if ((changes.flags & (Game::CHANGE_FALLING | Game::CHANGE_LOCKED
+                          | Game::CHANGE_ROWS | Game::CHANGE_SHOW_SHADOW)) != 0)
+    {
+        addDirtyTetromino(BOARD_X + TILE_SIZE * changes.fromBlock.x,
+                          BOARD_Y + TILE_SIZE * (changes.fromBlock.y + changes.fromShadowGap),
+                          changes.fromBlock);
+        addDirtyTetromino(BOARD_X + TILE_SIZE * block.x,
+                          BOARD_Y + TILE_SIZE * (block.y + mGame->shadowGap()), block);
+    }
+#endif
+    // Preview tetromino
+    if ((changes.flags & (Game::CHANGE_PREVIEW | Game::CHANGE_SHOW_PREVIEW)) != 0)
+    {
+        addDirtyRect(PREVIEW_X, PREVIEW_Y,
+                     TILE_SIZE * Game::TETROMINO_SIZE + 1,
+                     TILE_SIZE * Game::TETROMINO_SIZE + 1);
+    }
+
+    // Statistic counters, all of them are hidden or shown on pause
+    bool pauseChanged = ((changes.flags & Game::CHANGE_PAUSE) != 0);
+    if (pauseChanged)
+    {
+        for (int i = 0; i < COUNTER_COUNT; ++i)
+        {
+            addDirtyRect(mCounters[i].x + NUMBER_WIDTH, mCounters[i].y,
+                         NUMBER_WIDTH * mCounters[i].length, NUMBER_HEIGHT);
+        }
+    }
+    if ((changes.flags & Game::CHANGE_STATS) != 0)
+    {
+        updateStats(changes.stats, !pauseChanged);
+    }
+}
 
-        // Draw game statistic data
-        if (!mGame->isPaused())
+// Update the counters of the changed statistic fields
+void PlatformSdl::updateStats(unsigned int fields, bool redraw)
+{
+    const Game::StcStatics &stats = mGame->stats();
+    if ((fields & Game::STAT_LEVEL) != 0)
+    {
+        updateCounter(COUNTER_LEVEL, stats.level, redraw);
+    }
+    if ((fields & Game::STAT_LINES) != 0)
+    {
+        updateCounter(COUNTER_LINES, stats.lines, redraw);
+    }
+    if ((fields & Game::STAT_SCORE) != 0)
+    {
+        updateCounter(COUNTER_SCORE, stats.score, redraw);
+    }
+    if ((fields & Game::STAT_TOTAL_PIECES) != 0)
+    {
+        updateCounter(COUNTER_TOTAL_PIECES, stats.totalPieces, redraw);
+    }
+    for (int i = 0; i < Game::TETROMINO_TYPES; ++i)
+    {
+        if ((fields & (Game::STAT_PIECES << i)) != 0)
         {
-            drawNumber(LEVEL_X, LEVEL_Y, mGame->stats().level, LEVEL_LENGTH, Game::COLOR_WHITE);
-            drawNumber(LINES_X, LINES_Y, mGame->stats().lines, LINES_LENGTH, Game::COLOR_WHITE);
-            drawNumber(SCORE_X, SCORE_Y, mGame->stats().score, SCORE_LENGTH, Game::COLOR_WHITE);
-
-            drawNumber(TETROMINO_X, TETROMINO_L_Y, mGame->stats().pieces[Game::TETROMINO_L], TETROMINO_LENGTH, Game::COLOR_ORANGE);
-            drawNumber(TETROMINO_X, TETROMINO_I_Y, mGame->stats().pieces[Game::TETROMINO_I], TETROMINO_LENGTH, Game::COLOR_CYAN);
-            drawNumber(TETROMINO_X, TETROMINO_T_Y, mGame->stats().pieces[Game::TETROMINO_T], TETROMINO_LENGTH, Game::COLOR_PURPLE);
-            drawNumber(TETROMINO_X, TETROMINO_S_Y, mGame->stats().pieces[Game::TETROMINO_S], TETROMINO_LENGTH, Game::COLOR_GREEN);
-            drawNumber(TETROMINO_X, TETROMINO_Z_Y, mGame->stats().pieces[Game::TETROMINO_Z], TETROMINO_LENGTH, Game::COLOR_RED);
-            drawNumber(TETROMINO_X, TETROMINO_O_Y, mGame->stats().pieces[Game::TETROMINO_O], TETROMINO_LENGTH, Game::COLOR_YELLOW);
-            drawNumber(TETROMINO_X, TETROMINO_J_Y, mGame->stats().pieces[Game::TETROMINO_J], TETROMINO_LENGTH, Game::COLOR_BLUE);
-
-            drawNumber(PIECES_X, PIECES_Y, mGame->stats().totalPieces, PIECES_LENGTH, Game::COLOR_WHITE);
+            updateCounter(COUNTER_PIECES + i, stats.pieces[i], redraw);
         }
+    }
+}
+
+// Redraw a region of the screen
+void PlatformSdl::repaint(const SDL_Rect &rect)
+{
+    mClip = rect;
+    SDL_SetClipRect(mScreen, &mClip);
+
+    SDL_Rect recSource;
+    SDL_Rect recDestine;
+
+    // Find the part of the region covered by the board layer
+    SDL_Rect board;
+    board.x = (Sint16)((rect.x > BOARD_X)? rect.x : BOARD_X);
+    board.y = (Sint16)((rect.y > BOARD_Y)? rect.y : BOARD_Y);
+    int right = rect.x + rect.w;
+    int bottom = rect.y + rect.h;
+    if (right > BOARD_X + mBoardLayer->w)
+    {
+        right = BOARD_X + mBoardLayer->w;
+    }
+    if (bottom > BOARD_Y + mBoardLayer->h)
+    {
+        bottom = BOARD_Y + mBoardLayer->h;
+    }
+    board.w = (Uint16)((right > board.x)? right - board.x : 0);
+    board.h = (Uint16)((bottom > board.y)? bottom - board.y : 0);
+
+    // Restore background, unless the board layer covers the whole region
+    if ((board.w != rect.w) || (board.h != rect.h))
+    {
+        recSource = rect;
+        recDestine = rect;
+        if (mBmpBack != NULL)
+        {
+            blit(mBmpBack, &recSource, mScreen, &recDestine);
+        }
+        else
+        {
+            SDL_FillRect(mScreen, &recDestine, 0);
+        }
+    }
+
+    // Draw preview block
+    if (mGame->showPreview())
+    {
+        drawTetromino(PREVIEW_X, PREVIEW_Y, mGame->nextBlock(), false);
+    }
+
+    // Draw the locked cells from the board layer
+    if ((board.w > 0) && (board.h > 0))
+    {
+        recSource = board;
+        recSource.x = (Sint16)(recSource.x - BOARD_X);
+        recSource.y = (Sint16)(recSource.y - BOARD_Y);
+        blit(mBoardLayer, &recSource, mScreen, &board);
+    }
+#ifdef STC_SHOW_GHOST_PIECE
+    // Draw shadow tetromino
+    if (mGame->showShadow() && mGame->shadowGap() > 0)
+    {
+        drawTetromino(BOARD_X + (TILE_SIZE * mGame->fallingBlock().x),
+                      BOARD_Y + (TILE_SIZE * (mGame->fallingBlock().y + mGame->shadowGap())),
+                      mGame->fallingBlock(), true);
+    }
+#endif
+    // Draw falling tetromino
+    drawTetromino(BOARD_X + (TILE_SIZE * mGame->fallingBlock().x),
+                  BOARD_Y + (TILE_SIZE * mGame->fallingBlock().y),
+                  mGame->fallingBlock(), false);
+
+    // Draw game statistic data
+    if (!mGame->isPaused())
+    {
+        for (int i = 0; i < COUNTER_COUNT; ++i)
+        {
+            drawCounter(mCounters[i]);
+        }
+    }
+
+    SDL_SetClipRect(mScreen, NULL);
+}
+
+// Render the state of the game using platform functions
+void PlatformSdl::renderGame()
+{
+    // Use the images decoded since the last frame
+    bool loaded = updateImages();
+
+    // Check if the game state has changed, if so redraw the damaged regions
+    if (mGame->hasChanged() || loaded)
+    {
+        findDamage();
+
+        if (mFullRedraw)
+        {
+            SDL_Rect screen = {0, 0, SCREEN_WIDTH, SCREEN_HEIGHT};
+            repaint(screen);
+            SDL_UpdateRect(mScreen, 0, 0, 0, 0);
+        }
+        else
+        {
+            for (int i = 0; i < mDirtyCount; ++i)
+            {
+                repaint(mDirtyRects[i]);
+            }
+            SDL_UpdateRects(mScreen, mDirtyCount, mDirtyRects);
+        }
+        mDirtyCount = 0;
+        mFullRedraw = false;
 
         // Inform the game that we are done with the changed state
         mGame->onChangeProcessed();
+    }
 
-        // Swap video buffers
-        SDL_Flip(mScreen);
+    // Play the sounds of the frame and rest
+    endFrame();
+}
+
+// Take the images decoded by the loading threads, return true if the
+// screen must be redrawn. An image that fails to load stops the game
+// with ERROR_NO_IMAGES.
+bool PlatformSdl::updateImages()
+{
+    bool loaded = false;
+    if (mLoadBack.isDone())
+    {
+        mBmpBack = convertImage((SDL_Surface *)mLoadBack.take(), true);
+        if (mBmpBack == NULL)
+        {
+            mGame->setErrorCode(Game::ERROR_NO_IMAGES);
+            return false;
+        }
+        updateBoardLayer(0, 0, Game::BOARD_TILEMAP_WIDTH, Game::BOARD_TILEMAP_HEIGHT);
+        loaded = true;
+    }
+    if (mLoadNumbers.isDone())
+    {
+        mBmpNumbers = convertImage((SDL_Surface *)mLoadNumbers.take(), false);
+        if (mBmpNumbers == NULL)
+        {
+            mGame->setErrorCode(Game::ERROR_NO_IMAGES);
+            return false;
+        }
+        loaded = true;
     }
+    if (loaded)
+    {
+        mFullRedraw = true;
+    }
+    return loaded;
+}
+
+// Give the sounds requested during the frame to the mixer and rest
+void PlatformSdl::endFrame()
+{
+    mAudio.flush();
+
+    // Let the bot see the new state
+    mShared.publish(*mGame);
 
     // Resting game
-    SDL_Delay(SLEEP_TIME);
+    if (mGame->profiler() != NULL)
+    {
+        mGame->profiler()->begin(FrameProfiler::PHASE_SLEEP);
+    }
+    STC_TRACE_SPAN("sleep");
+    if (!mBenchmark)
+    {
+        SDL_Delay(SLEEP_TIME);
+    }
 }
 
 // Return a random positive integer number
 int PlatformSdl::random()
 {
-    return rand();
+    return Replay::random(mRandomState);
 }
 
 void PlatformSdl::onLineCompleted()
 {
-	Mix_PlayChannel(-1, mSoundLine, 0);
+    mAudio.play(AudioSdl::SOUND_LINE);
 }
 
 void PlatformSdl::onPieceDrop()
 {
-	Mix_PlayChannel(-1, mSoundDrop, 0);
+    mAudio.play(AudioSdl::SOUND_DROP);
 }
 
-// Release platform allocated resources
-void PlatformSdl::end()
+// Release the resources used for rendering
+void PlatformSdl::endRenderer()
 {
+    // Wait for the loading threads
+    SDL_FreeSurface((SDL_Surface *)mLoadBack.take());
+    SDL_FreeSurface((SDL_Surface *)mLoadNumbers.take());
+
     // Free all the created surfaces
     SDL_FreeSurface(mBmpTiles);
     SDL_FreeSurface(mBmpBack);
     SDL_FreeSurface(mBmpNumbers);
+    SDL_FreeSurface(mBoardLayer);
     SDL_FreeSurface(mScreen);
+}
+
+// Release platform allocated resources
+void PlatformSdl::end()
+{
+    // Save the replay
+    if (mReplayFile != NULL)
+    {
+        mReplay.save(mReplayFile);
+    }
+
+    endRenderer();
+
+    // Close the audio device
+    if (!mBenchmark)
+    {
+        mAudio.close();
+    }
+
+    // Remove the segment shared with the bot
+    mShared.close();
 
-	// Close SDL_mixer
-	Mix_CloseAudio();
+    // Release the asset pack
+    AssetsSdl::usePack(NULL);
+    mPack.close();
 
     // Shut down SDL
     SDL_Quit();
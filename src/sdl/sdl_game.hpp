@@ -9,12 +9,16 @@
 /* -------------------------------------------------------------------------- */
 
 #include "../game.hpp"
+#include "../replay.hpp"
+#include "sdl_audio.hpp"
+#include "sdl_loader.hpp"
+#include "sdl_assets.hpp"
+#include "../shm/shm_state.hpp"
 
 #ifndef STC_SDL_GAME_HPP_
 #define STC_SDL_GAME_HPP_
 
 #include <SDL.h>
-#include <SDL_mixer.h>
 
 namespace stc
 {
@@ -23,14 +27,13 @@ namespace stc
 #define STC_BMP_TILE_BLOCKS     "assets/blocks.png"
 #define STC_BMP_BACKGROUND      "assets/back.png"
 #define STC_BMP_NUMBERS         "assets/numbers.png"
-#define STC_SND_MUSIC			"assets/stc_theme_loop.ogg"
-#define STC_SND_LINE			"assets/fx_line.wav"
-#define STC_SND_DROP			"assets/fx_drop.wav"
 
 // SDL platform implementation
 class PlatformSdl : public Platform
 {
-    // UI layout (quantities are expressed in pixels)
+public:
+    // UI layout (quantities are expressed in pixels), public for the
+    // benchmarks and tools that draw the same screen
 
     // Screen size
     static const int SCREEN_WIDTH  = 480;
@@ -84,17 +87,47 @@ class PlatformSdl : public Platform
     static const int NUMBER_WIDTH  = 7;
     static const int NUMBER_HEIGHT = 9;
 
+    // Maximum number of digits of a counter
+    static const int NUMBER_MAX_LENGTH = 10;
+
+protected:
     // Use 32 bits per pixel
     static const int SCREEN_BIT_DEPTH = 32;
 
-    // Use video hardware and double buffering
-    static const int SCREEN_VIDEO_MODE = (SDL_HWSURFACE | SDL_DOUBLEBUF);
+    // Use a single buffered software surface, damaged regions are pushed
+    // to the display with SDL_UpdateRects (this doesn't work with flipping)
+    static const int SCREEN_VIDEO_MODE = SDL_SWSURFACE;
+
+    // Maximum number of damaged regions tracked per frame, if there are
+    // more the whole screen is redrawn
+    static const int MAX_DIRTY_RECTS = 32;
 
     // Sleep time (in milliseconds)
     static const int SLEEP_TIME = 40;
 
 public:
 
+    PlatformSdl();
+
+    // Record the game in a replay file, call it before init
+    void recordReplay(const char *file);
+
+    // Use a small mixer buffer of [samples] that grows if the sound
+    // breaks, call it before init
+    void setLowLatencyAudio(int samples);
+
+    // Run without audio and without resting between frames, the images are
+    // loaded before the first frame. Used for measuring the rendering, call
+    // it before init.
+    void setBenchmark(bool benchmark);
+
+    // Publish the game state every frame in the shared memory segment
+    // [name] and take key presses from it, call it before init
+    void setSharedState(const char *name);
+
+    // Return the number of blits done since init
+    long blitCount()    { return mBlitCount; }
+
     // Initializes platform
     virtual int init(Game *game);
 
@@ -117,21 +150,113 @@ public:
     virtual void onLineCompleted();
     virtual void onPieceDrop();
 
+    // Load an image and convert it to the screen format, return NULL on error
+    static SDL_Surface* loadImage(const char *file, bool opaque);
+
+protected:
+
+    Game* mGame;
+
+    // Create the screen and load the resources used for rendering
+    virtual int initRenderer();
+
+    // Release the resources used for rendering
+    virtual void endRenderer();
+
+    // Play the sounds requested during the frame and rest, call it at the
+    // end of renderGame
+    void endFrame();
+
 private:
 
+    // Time of the current game update
+    long mFrameTime;
+
+    // Benchmark mode and blits done
+    bool mBenchmark;
+    long mBlitCount;
+
+    // Random number generator state
+    unsigned int mRandomState;
+
+    // Replay recorded if there is a file for it
+    Replay      mReplay;
+    const char* mReplayFile;
+
+    // State shared with a bot if there is a segment name for it
+    SharedState mShared;
+    const char* mSharedName;
+
+    void sendEvent(bool start, int event);
+
     SDL_Surface* mScreen;
     SDL_Surface* mBmpTiles;
     SDL_Surface* mBmpBack;
     SDL_Surface* mBmpNumbers;
 
-    Mix_Music* mMusic;
-	Mix_Chunk *mSoundLine;
-	Mix_Chunk *mSoundDrop;
-
-    Game* mGame;
-
+    // Images decoded in worker threads, they are NULL until they are ready
+    AsyncLoad mLoadBack;
+    AsyncLoad mLoadNumbers;
+
+    // Background of the board with the locked cells drawn over it, only
+    // updated when cells are locked or rows are cleared
+    SDL_Surface* mBoardLayer;
+
+    // Music and sound effects
+    AudioSdl mAudio;
+
+    // Asset pack, used if it exists
+    AssetPack mPack;
+
+    // Damaged regions of the screen for the current frame
+    SDL_Rect mDirtyRects[MAX_DIRTY_RECTS];
+    int      mDirtyCount;
+    bool     mFullRedraw;
+
+    // Region being repainted, drawing outside of it is skipped
+    SDL_Rect mClip;
+
+    // Statistic counters shown on screen
+    enum
+    {
+        COUNTER_LEVEL,
+        COUNTER_LINES,
+        COUNTER_SCORE,
+        COUNTER_TOTAL_PIECES,
+        COUNTER_PIECES,  // followed by one counter for every tetromino type
+        COUNTER_COUNT = COUNTER_PIECES + Game::TETROMINO_TYPES
+    };
+
+    // Counter data, the digits are cached so only the changed ones are redrawn
+    struct StcCounter
+    {
+        int x;
+        int y;
+        int length;
+        int color;
+        long value;
+        int digits[NUMBER_MAX_LENGTH]; // from the least significant digit
+    };
+    StcCounter mCounters[COUNTER_COUNT];
+
+    void blit(SDL_Surface *source, SDL_Rect *sourceRect, SDL_Surface *target, SDL_Rect *targetRect);
     void drawTile(int x, int y, int tile, bool shadow);
-    void drawNumber(int x, int y, long number, int length, int color);
+    void drawCounter(const StcCounter &counter);
+    void drawTetromino(int x, int y, const Game::StcTetromino &block, bool shadow);
+
+    void updateBoardLayer(int column, int row, int width, int height);
+
+    void addDirtyRect(int x, int y, int w, int h);
+    void addDirtyTetromino(int x, int y, const Game::StcTetromino &block);
+    void setCounter(int counter, int x, int y, int length, int color);
+    void updateCounter(int counter, long value, bool redraw);
+    void findDamage();
+    void updateStats(unsigned int fields, bool redraw);
+    void repaint(const SDL_Rect &rect);
+    bool updateImages();
+
+    static void *decodeImage(const char *file);
+    static SDL_Surface* convertImage(SDL_Surface *image, bool opaque);
 };
 }
 
@@ -0,0 +1,303 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   SDL implementation rendering with OpenGL 1.1.                            */
+/*   Only OpenGL 1.1 vertex arrays are used, so it runs on any driver         */
+/*   including Mesa's software rasterizer when there is no GPU:               */
+/*       LIBGL_ALWAYS_SOFTWARE=1 ./stc++gl                                    */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "sdl_game_gl.hpp"
+#include <SDL_image.h>
+
+namespace stc
+{
+
+// Copy an image to the atlas surface, the pixels are copied as they are and
+// colorkeyed pixels are skipped (they stay transparent). Return false on error.
+static bool copyToAtlas(SDL_Surface *atlas, const char *file, int x, int y)
+{
+    SDL_Surface *image = IMG_Load_RW(AssetsSdl::open(file), 1);
+    if (image == NULL)
+    {
+        return false;
+    }
+    SDL_SetAlpha(image, 0, SDL_ALPHA_OPAQUE);
+
+    // The SDL renderer converts the images to the display format, so every
+    // pixel with the color of the key is transparent, not only the key index
+    bool keyed = (image->flags & SDL_SRCCOLORKEY) != 0;
+    Uint32 key = 0;
+    if (keyed)
+    {
+        Uint8 r, g, b;
+        SDL_GetRGB(image->format->colorkey, image->format, &r, &g, &b);
+        key = SDL_MapRGB(atlas->format, r, g, b);
+    }
+
+    SDL_Rect recDestine;
+    recDestine.x = (Sint16)x;
+    recDestine.y = (Sint16)y;
+    SDL_BlitSurface(image, NULL, atlas, &recDestine);
+    SDL_FreeSurface(image);
+
+    if (keyed)
+    {
+        for (int j = recDestine.y; j < recDestine.y + recDestine.h; ++j)
+        {
+            Uint32 *row = (Uint32 *)((Uint8 *)atlas->pixels + j * atlas->pitch);
+            for (int i = recDestine.x; i < recDestine.x + recDestine.w; ++i)
+            {
+                if (row[i] == key)
+                {
+                    row[i] = 0;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+PlatformSdlGl::PlatformSdlGl()
+{
+    mAtlas = 0;
+    mQuadCount = 0;
+}
+
+// Create the OpenGL screen and upload the texture atlas,
+// if there are no problems returns ERROR_NONE.
+int PlatformSdlGl::initRenderer()
+{
+    SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+    if (SDL_SetVideoMode(SCREEN_WIDTH, SCREEN_HEIGHT, 0, SDL_OPENGL) == NULL)
+    {
+        return Game::ERROR_NO_VIDEO;
+    }
+
+    // Pack all the images in a RGBA surface with the byte order used by OpenGL
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+    SDL_Surface *atlas = SDL_CreateRGBSurface(SDL_SWSURFACE, ATLAS_SIZE, ATLAS_SIZE, 32,
+                                              0xff000000, 0x00ff0000, 0x0000ff00, 0x000000ff);
+#else
+    SDL_Surface *atlas = SDL_CreateRGBSurface(SDL_SWSURFACE, ATLAS_SIZE, ATLAS_SIZE, 32,
+                                              0x000000ff, 0x0000ff00, 0x00ff0000, 0xff000000);
+#endif
+    if (atlas == NULL)
+    {
+        return Game::ERROR_NO_MEMORY;
+    }
+    SDL_FillRect(atlas, NULL, 0);
+
+    if (!copyToAtlas(atlas, STC_BMP_BACKGROUND, ATLAS_BACK_X, ATLAS_BACK_Y)
+            || !copyToAtlas(atlas, STC_BMP_TILE_BLOCKS, ATLAS_TILES_X, ATLAS_TILES_Y)
+            || !copyToAtlas(atlas, STC_BMP_NUMBERS, ATLAS_NUMBERS_X, ATLAS_NUMBERS_Y))
+    {
+        SDL_FreeSurface(atlas);
+        return Game::ERROR_NO_IMAGES;
+    }
+
+    // Upload the atlas, pixels are mapped one to one so there is no filtering
+    glGenTextures(1, &mAtlas);
+    glBindTexture(GL_TEXTURE_2D, mAtlas);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, ATLAS_SIZE, ATLAS_SIZE, 0,
+                 GL_RGBA, GL_UNSIGNED_BYTE, atlas->pixels);
+    SDL_FreeSurface(atlas);
+
+    if (glGetError() != GL_NO_ERROR)
+    {
+        return Game::ERROR_NO_VIDEO;
+    }
+
+    // Screen coordinates are pixels with the origin on the up-left corner
+    glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    glOrtho(0, SCREEN_WIDTH, SCREEN_HEIGHT, 0, -1, 1);
+    glMatrixMode(GL_MODELVIEW);
+    glLoadIdentity();
+
+    // Texture coordinates are pixels of the atlas
+    glMatrixMode(GL_TEXTURE);
+    glLoadIdentity();
+    glScalef(1.0f / ATLAS_SIZE, 1.0f / ATLAS_SIZE, 1.0f);
+    glMatrixMode(GL_MODELVIEW);
+
+    // Transparent pixels are discarded, like colorkeyed blits
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_LIGHTING);
+    glEnable(GL_TEXTURE_2D);
+    glEnable(GL_ALPHA_TEST);
+    glAlphaFunc(GL_GREATER, 0.5f);
+
+    // The batch arrays are always the same
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glVertexPointer(2, GL_SHORT, 0, mVertices);
+    glTexCoordPointer(2, GL_SHORT, 0, mTexCoords);
+
+    mQuadCount = 0;
+    return Game::ERROR_NONE;
+}
+
+// Release the texture atlas
+void PlatformSdlGl::endRenderer()
+{
+    if (mAtlas != 0)
+    {
+        glDeleteTextures(1, &mAtlas);
+    }
+}
+
+// Add a quad to the batch
+void PlatformSdlGl::addQuad(int x, int y, int w, int h, int u, int v)
+{
+    if (mQuadCount == MAX_QUADS)
+    {
+        drawBatch();
+    }
+    GLshort *vertex = &mVertices[mQuadCount * 8];
+    GLshort *texCoord = &mTexCoords[mQuadCount * 8];
+
+    vertex[0] = (GLshort)x;       vertex[1] = (GLshort)y;
+    vertex[2] = (GLshort)(x + w); vertex[3] = (GLshort)y;
+    vertex[4] = (GLshort)(x + w); vertex[5] = (GLshort)(y + h);
+    vertex[6] = (GLshort)x;       vertex[7] = (GLshort)(y + h);
+
+    texCoord[0] = (GLshort)u;       texCoord[1] = (GLshort)v;
+    texCoord[2] = (GLshort)(u + w); texCoord[3] = (GLshort)v;
+    texCoord[4] = (GLshort)(u + w); texCoord[5] = (GLshort)(v + h);
+    texCoord[6] = (GLshort)u;       texCoord[7] = (GLshort)(v + h);
+
+    ++mQuadCount;
+}
+
+// Add a tile from a tetromino
+void PlatformSdlGl::addTile(int x, int y, int tile, bool shadow)
+{
+    addQuad(x, y, TILE_SIZE + 1, TILE_SIZE + 1,
+            ATLAS_TILES_X + TILE_SIZE * tile,
+            ATLAS_TILES_Y + (TILE_SIZE + 1) * (shadow? 1 : 0));
+}
+
+// Add the cells of a tetromino with its up-left corner on the given position
+void PlatformSdlGl::addTetromino(int x, int y, const Game::StcTetromino &block, bool shadow)
+{
+    for (int i = 0; i < Game::TETROMINO_SIZE; ++i)
+    {
+        for (int j = 0; j < Game::TETROMINO_SIZE; ++j)
+        {
+            if (block.cells[i][j] != Game::EMPTY_CELL)
+            {
+                addTile(x + (TILE_SIZE * i), y + (TILE_SIZE * j), block.cells[i][j], shadow);
+            }
+        }
+    }
+}
+
+// Add the digits of a number on the given position
+void PlatformSdlGl::addNumber(int x, int y, long number, int length, int color)
+{
+    int pos = 0;
+    do
+    {
+        addQuad(x + NUMBER_WIDTH * (length - pos), y, NUMBER_WIDTH, NUMBER_HEIGHT,
+                ATLAS_NUMBERS_X + NUMBER_WIDTH * (int)(number % 10),
+                ATLAS_NUMBERS_Y + NUMBER_HEIGHT * color);
+        number /= 10;
+    } while (++pos < length);
+}
+
+// Draw the quads in the batch with a single call and empty it
+void PlatformSdlGl::drawBatch()
+{
+    if (mQuadCount > 0)
+    {
+        glDrawArrays(GL_QUADS, 0, 4 * mQuadCount);
+        mQuadCount = 0;
+    }
+}
+
+// Render the state of the game, the whole frame is drawn in one batch
+void PlatformSdlGl::renderGame()
+{
+    int i, j;
+
+    // Check if the game state has changed, if so redraw
+    if (mGame->hasChanged())
+    {
+        // Draw background
+        addQuad(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT, ATLAS_BACK_X, ATLAS_BACK_Y);
+
+        // Draw preview block
+        if (mGame->showPreview())
+        {
+            addTetromino(PREVIEW_X, PREVIEW_Y, mGame->nextBlock(), false);
+        }
+#ifdef STC_SHOW_GHOST_PIECE
+        // Draw shadow tetromino
+        if (mGame->showShadow() && mGame->shadowGap() > 0)
+        {
+            addTetromino(BOARD_X + (TILE_SIZE * mGame->fallingBlock().x),
+                         BOARD_Y + (TILE_SIZE * (mGame->fallingBlock().y + mGame->shadowGap())),
+                         mGame->fallingBlock(), true);
+        }
+#endif
+        // Draw the cells in the board
+        for (i = 0; i < Game::BOARD_TILEMAP_WIDTH; ++i)
+        {
+            for (j = 0; j < Game::BOARD_TILEMAP_HEIGHT; ++j)
+            {
+                if (mGame->getCell(i, j) != Game::EMPTY_CELL)
+                {
+                    addTile(BOARD_X + (TILE_SIZE * i),
+                            BOARD_Y + (TILE_SIZE * j),
+                            mGame->getCell(i, j), false);
+                }
+            }
+        }
+
+        // Draw falling tetromino
+        addTetromino(BOARD_X + (TILE_SIZE * mGame->fallingBlock().x),
+                     BOARD_Y + (TILE_SIZE * mGame->fallingBlock().y),
+                     mGame->fallingBlock(), false);
+
+        // Draw game statistic data
+        if (!mGame->isPaused())
+        {
+            addNumber(LEVEL_X, LEVEL_Y, mGame->stats().level, LEVEL_LENGTH, Game::COLOR_WHITE);
+            addNumber(LINES_X, LINES_Y, mGame->stats().lines, LINES_LENGTH, Game::COLOR_WHITE);
+            addNumber(SCORE_X, SCORE_Y, mGame->stats().score, SCORE_LENGTH, Game::COLOR_WHITE);
+
+            addNumber(TETROMINO_X, TETROMINO_L_Y, mGame->stats().pieces[Game::TETROMINO_L], TETROMINO_LENGTH, Game::COLOR_ORANGE);
+            addNumber(TETROMINO_X, TETROMINO_I_Y, mGame->stats().pieces[Game::TETROMINO_I], TETROMINO_LENGTH, Game::COLOR_CYAN);
+            addNumber(TETROMINO_X, TETROMINO_T_Y, mGame->stats().pieces[Game::TETROMINO_T], TETROMINO_LENGTH, Game::COLOR_PURPLE);
+            addNumber(TETROMINO_X, TETROMINO_S_Y, mGame->stats().pieces[Game::TETROMINO_S], TETROMINO_LENGTH, Game::COLOR_GREEN);
+            addNumber(TETROMINO_X, TETROMINO_Z_Y, mGame->stats().pieces[Game::TETROMINO_Z], TETROMINO_LENGTH, Game::COLOR_RED);
+            addNumber(TETROMINO_X, TETROMINO_O_Y, mGame->stats().pieces[Game::TETROMINO_O], TETROMINO_LENGTH, Game::COLOR_YELLOW);
+            addNumber(TETROMINO_X, TETROMINO_J_Y, mGame->stats().pieces[Game::TETROMINO_J], TETROMINO_LENGTH, Game::COLOR_BLUE);
+
+            addNumber(PIECES_X, PIECES_Y, mGame->stats().totalPieces, PIECES_LENGTH, Game::COLOR_WHITE);
+        }
+
+        drawBatch();
+
+        // Inform the game that we are done with the changed state
+        mGame->onChangeProcessed();
+
+        // Swap video buffers
+        SDL_GL_SwapBuffers();
+    }
+
+    // Play the sounds of the frame and rest
+    endFrame();
+}
+}
@@ -0,0 +1,75 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Constants and definitions for the SDL implementation using OpenGL.       */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "sdl_game.hpp"
+
+#ifndef STC_SDL_GAME_GL_HPP_
+#define STC_SDL_GAME_GL_HPP_
+
+#include <SDL_opengl.h>
+
+namespace stc
+{
+
+// SDL platform implementation rendering with OpenGL 1.1.
+// All the images are uploaded once to a texture atlas and every frame is
+// drawn with a single batch of textured quads. Input, timing and sound are
+// handled by the SDL platform.
+class PlatformSdlGl : public PlatformSdl
+{
+protected:
+    // Texture atlas size (it must be a power of two for OpenGL 1.1)
+    static const int ATLAS_SIZE = 512;
+
+    // Position of the images inside the texture atlas
+    static const int ATLAS_BACK_X    = 0;
+    static const int ATLAS_BACK_Y    = 0;
+    static const int ATLAS_TILES_X   = 0;
+    static const int ATLAS_TILES_Y   = 288;
+    static const int ATLAS_NUMBERS_X = 128;
+    static const int ATLAS_NUMBERS_Y = 288;
+
+    // Maximum number of quads drawn in a batch
+    static const int MAX_QUADS = 1024;
+
+public:
+
+    PlatformSdlGl();
+
+    // Render the state of the game
+    virtual void renderGame();
+
+protected:
+
+    // Create the OpenGL screen and upload the texture atlas
+    virtual int initRenderer();
+
+    // Release the texture atlas
+    virtual void endRenderer();
+
+    // Add quads to the batch, (u, v) is the source position in the atlas
+    void addQuad(int x, int y, int w, int h, int u, int v);
+    void addTile(int x, int y, int tile, bool shadow);
+    void addTetromino(int x, int y, const Game::StcTetromino &block, bool shadow);
+    void addNumber(int x, int y, long number, int length, int color);
+
+    // Draw the quads in the batch and empty it
+    void drawBatch();
+
+private:
+
+    GLuint  mAtlas;
+    GLshort mVertices[MAX_QUADS * 8];
+    GLshort mTexCoords[MAX_QUADS * 8];
+    int     mQuadCount;
+};
+}
+
+#endif // STC_SDL_GAME_GL_HPP_
@@ -0,0 +1,232 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   SDL implementation rendering with the software rasterizer.               */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "sdl_game_soft.hpp"
+#include <SDL_image.h>
+
+namespace stc
+{
+
+PlatformSdlSoft::PlatformSdlSoft()
+{
+    mTarget = NULL;
+    mSurfaceTiles = NULL;
+    mSurfaceBack = NULL;
+    mSurfaceNumbers = NULL;
+}
+
+// Create the screen and load the images, if there are no problems returns ERROR_NONE.
+int PlatformSdlSoft::initRenderer()
+{
+    mTarget = SDL_SetVideoMode(SCREEN_WIDTH, SCREEN_HEIGHT, 32, SDL_SWSURFACE);
+    if (mTarget == NULL || mTarget->format->BytesPerPixel != 4)
+    {
+        return Game::ERROR_NO_VIDEO;
+    }
+
+    // Images use the color layout of the screen so pixels are just copied
+    return loadImages(mTarget->format->Rmask, mTarget->format->Gmask, mTarget->format->Bmask);
+}
+
+// Load the images for drawing frames without a screen
+int PlatformSdlSoft::initHeadless(Game *game)
+{
+    mGame = game;
+    mTarget = NULL;
+    return loadImages(0x00ff0000, 0x0000ff00, 0x000000ff);
+}
+
+// Release the images loaded by initHeadless
+void PlatformSdlSoft::endHeadless()
+{
+    endRenderer();
+}
+
+// Load the images with the given color masks
+int PlatformSdlSoft::loadImages(Uint32 rmask, Uint32 gmask, Uint32 bmask)
+{
+    mSurfaceTiles = loadImage32(STC_BMP_TILE_BLOCKS, rmask, gmask, bmask);
+    mSurfaceBack = loadImage32(STC_BMP_BACKGROUND, rmask, gmask, bmask);
+    mSurfaceNumbers = loadImage32(STC_BMP_NUMBERS, rmask, gmask, bmask);
+
+    if (mSurfaceTiles == NULL || mSurfaceBack == NULL || mSurfaceNumbers == NULL)
+    {
+        return Game::ERROR_NO_IMAGES;
+    }
+    mImageTiles = imageOf(mSurfaceTiles);
+    mImageBack = imageOf(mSurfaceBack);
+    mImageNumbers = imageOf(mSurfaceNumbers);
+    mAlphaMask = ~(rmask | gmask | bmask);
+    return Game::ERROR_NONE;
+}
+
+// Load an image converted to 32 bits per pixel. The alpha bits are set on
+// the pixels copied from the image and colorkeyed pixels are left clear.
+SDL_Surface* PlatformSdlSoft::loadImage32(const char *file, Uint32 rmask, Uint32 gmask, Uint32 bmask)
+{
+    SDL_Surface *image = IMG_Load_RW(AssetsSdl::open(file), 1);
+    if (image == NULL)
+    {
+        return NULL;
+    }
+    SDL_Surface *converted = SDL_CreateRGBSurface(SDL_SWSURFACE, image->w, image->h, 32,
+                                                  rmask, gmask, bmask, ~(rmask | gmask | bmask));
+    if (converted != NULL)
+    {
+        SDL_FillRect(converted, NULL, 0);
+        SDL_SetAlpha(image, 0, SDL_ALPHA_OPAQUE);
+        SDL_BlitSurface(image, NULL, converted, NULL);
+    }
+    SDL_FreeSurface(image);
+    return converted;
+}
+
+// Image view of the pixels of a 32 bits per pixel surface
+StcImage PlatformSdlSoft::imageOf(SDL_Surface *surface)
+{
+    StcImage image;
+    image.pixels = (uint32_t *)surface->pixels;
+    image.width = surface->w;
+    image.height = surface->h;
+    image.pitch = surface->pitch / 4;
+    return image;
+}
+
+// Draw a tile from a tetromino
+void PlatformSdlSoft::drawTile(const StcImage &frame, int x, int y, int tile, bool shadow)
+{
+    SoftRaster::copyMasked(frame, x, y, mImageTiles,
+                           TILE_SIZE * tile, (TILE_SIZE + 1) * (shadow? 1 : 0),
+                           TILE_SIZE + 1, TILE_SIZE + 1, mAlphaMask);
+}
+
+// Draw the cells of a tetromino with its up-left corner on the given position
+void PlatformSdlSoft::drawTetromino(const StcImage &frame, int x, int y,
+                                    const Game::StcTetromino &block, bool shadow)
+{
+    for (int i = 0; i < Game::TETROMINO_SIZE; ++i)
+    {
+        for (int j = 0; j < Game::TETROMINO_SIZE; ++j)
+        {
+            if (block.cells[i][j] != Game::EMPTY_CELL)
+            {
+                drawTile(frame, x + (TILE_SIZE * i), y + (TILE_SIZE * j), block.cells[i][j], shadow);
+            }
+        }
+    }
+}
+
+// Draw the digits of a number on the given position
+void PlatformSdlSoft::drawNumber(const StcImage &frame, int x, int y, long number, int length, int color)
+{
+    int pos = 0;
+    do
+    {
+        SoftRaster::copyMasked(frame, x + NUMBER_WIDTH * (length - pos), y, mImageNumbers,
+                               NUMBER_WIDTH * (int)(number % 10), NUMBER_HEIGHT * color,
+                               NUMBER_WIDTH, NUMBER_HEIGHT, mAlphaMask);
+        number /= 10;
+    } while (++pos < length);
+}
+
+// Draw the state of the game on a frame
+void PlatformSdlSoft::drawFrame(const StcImage &frame)
+{
+    int i, j;
+
+    // Draw background
+    SoftRaster::copy(frame, 0, 0, mImageBack, 0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+
+    // Draw preview block
+    if (mGame->showPreview())
+    {
+        drawTetromino(frame, PREVIEW_X, PREVIEW_Y, mGame->nextBlock(), false);
+    }
+
+    // Draw the cells in the board
+    for (i = 0; i < Game::BOARD_TILEMAP_WIDTH; ++i)
+    {
+        for (j = 0; j < Game::BOARD_TILEMAP_HEIGHT; ++j)
+        {
+            if (mGame->getCell(i, j) != Game::EMPTY_CELL)
+            {
+                drawTile(frame, BOARD_X + (TILE_SIZE * i), BOARD_Y + (TILE_SIZE * j),
+                         mGame->getCell(i, j), false);
+            }
+        }
+    }
+#ifdef STC_SHOW_GHOST_PIECE
+    // Draw shadow tetromino
+    if (mGame->showShadow() && mGame->shadowGap() > 0)
+    {
+        drawTetromino(frame, BOARD_X + (TILE_SIZE * mGame->fallingBlock().x),
+                      BOARD_Y + (TILE_SIZE * (mGame->fallingBlock().y + mGame->shadowGap())),
+                      mGame->fallingBlock(), true);
+    }
+#endif
+    // Draw falling tetromino
+    drawTetromino(frame, BOARD_X + (TILE_SIZE * mGame->fallingBlock().x),
+                  BOARD_Y + (TILE_SIZE * mGame->fallingBlock().y),
+                  mGame->fallingBlock(), false);
+
+    // Draw game statistic data
+    if (!mGame->isPaused())
+    {
+        const Game::StcStatics &stats = mGame->stats();
+        drawNumber(frame, LEVEL_X, LEVEL_Y, stats.level, LEVEL_LENGTH, Game::COLOR_WHITE);
+        drawNumber(frame, LINES_X, LINES_Y, stats.lines, LINES_LENGTH, Game::COLOR_WHITE);
+        drawNumber(frame, SCORE_X, SCORE_Y, stats.score, SCORE_LENGTH, Game::COLOR_WHITE);
+
+        drawNumber(frame, TETROMINO_X, TETROMINO_L_Y, stats.pieces[Game::TETROMINO_L], TETROMINO_LENGTH, Game::COLOR_ORANGE);
+        drawNumber(frame, TETROMINO_X, TETROMINO_I_Y, stats.pieces[Game::TETROMINO_I], TETROMINO_LENGTH, Game::COLOR_CYAN);
+        drawNumber(frame, TETROMINO_X, TETROMINO_T_Y, stats.pieces[Game::TETROMINO_T], TETROMINO_LENGTH, Game::COLOR_PURPLE);
+        drawNumber(frame, TETROMINO_X, TETROMINO_S_Y, stats.pieces[Game::TETROMINO_S], TETROMINO_LENGTH, Game::COLOR_GREEN);
+        drawNumber(frame, TETROMINO_X, TETROMINO_Z_Y, stats.pieces[Game::TETROMINO_Z], TETROMINO_LENGTH, Game::COLOR_RED);
+        drawNumber(frame, TETROMINO_X, TETROMINO_O_Y, stats.pieces[Game::TETROMINO_O], TETROMINO_LENGTH, Game::COLOR_YELLOW);
+        drawNumber(frame, TETROMINO_X, TETROMINO_J_Y, stats.pieces[Game::TETROMINO_J], TETROMINO_LENGTH, Game::COLOR_BLUE);
+
+        drawNumber(frame, PIECES_X, PIECES_Y, stats.totalPieces, PIECES_LENGTH, Game::COLOR_WHITE);
+    }
+}
+
+// Render the state of the game, the frame is drawn in the screen pixels
+// and shown with a single update
+void PlatformSdlSoft::renderGame()
+{
+    // Check if the game state has changed, if so redraw
+    if (mGame->hasChanged())
+    {
+        if (SDL_MUSTLOCK(mTarget))
+        {
+            SDL_LockSurface(mTarget);
+        }
+        drawFrame(imageOf(mTarget));
+        if (SDL_MUSTLOCK(mTarget))
+        {
+            SDL_UnlockSurface(mTarget);
+        }
+        SDL_UpdateRect(mTarget, 0, 0, 0, 0);
+
+        // Inform the game that we are done with the changed state
+        mGame->onChangeProcessed();
+    }
+
+    // Play the sounds of the frame and rest
+    endFrame();
+}
+
+// Release the images
+void PlatformSdlSoft::endRenderer()
+{
+    SDL_FreeSurface(mSurfaceTiles);
+    SDL_FreeSurface(mSurfaceBack);
+    SDL_FreeSurface(mSurfaceNumbers);
+}
+}
@@ -0,0 +1,81 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Constants and definitions for the SDL implementation using the           */
+/*   software rasterizer.                                                     */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "sdl_game.hpp"
+
+#ifndef STC_SDL_GAME_SOFT_HPP_
+#define STC_SDL_GAME_SOFT_HPP_
+
+#include "../soft/soft_raster.hpp"
+
+namespace stc
+{
+
+// SDL platform implementation rendering with the software rasterizer.
+// Every frame is composed directly in the pixels of the screen and shown
+// with a single update. SDL is only used for loading the images, so frames
+// can also be drawn without a screen (see initHeadless).
+class PlatformSdlSoft : public PlatformSdl
+{
+public:
+
+    PlatformSdlSoft();
+
+    // Render the state of the game
+    virtual void renderGame();
+
+    // Load the images for drawing frames of [game] without a screen,
+    // frames use the 0xAARRGGBB pixel format
+    int initHeadless(Game *game);
+
+    // Release the images loaded by initHeadless
+    void endHeadless();
+
+    // Draw the state of the game on a frame of the screen size
+    void drawFrame(const StcImage &frame);
+
+    // Load an image converted to 32 bits per pixel with the given color
+    // masks, the alpha bits are clear on transparent pixels. Return NULL on error.
+    static SDL_Surface* loadImage32(const char *file, Uint32 rmask, Uint32 gmask, Uint32 bmask);
+
+    // Image view of the pixels of a 32 bits per pixel surface
+    static StcImage imageOf(SDL_Surface *surface);
+
+protected:
+
+    // Create the screen and load the images
+    virtual int initRenderer();
+
+    // Release the images
+    virtual void endRenderer();
+
+    // Load the images with the given color masks
+    int loadImages(Uint32 rmask, Uint32 gmask, Uint32 bmask);
+
+    void drawTile(const StcImage &frame, int x, int y, int tile, bool shadow);
+    void drawTetromino(const StcImage &frame, int x, int y, const Game::StcTetromino &block, bool shadow);
+    void drawNumber(const StcImage &frame, int x, int y, long number, int length, int color);
+
+private:
+
+    SDL_Surface* mTarget;
+    SDL_Surface* mSurfaceTiles;
+    SDL_Surface* mSurfaceBack;
+    SDL_Surface* mSurfaceNumbers;
+
+    StcImage mImageTiles;
+    StcImage mImageBack;
+    StcImage mImageNumbers;
+    Uint32   mAlphaMask;
+};
+}
+
+#endif // STC_SDL_GAME_SOFT_HPP_
@@ -0,0 +1,98 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Loading of asset files in worker threads.                                */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "sdl_loader.hpp"
+
+namespace stc
+{
+
+AsyncLoad::AsyncLoad()
+{
+    mLoad = NULL;
+    mFile = NULL;
+    mResult = NULL;
+    mDone = false;
+    mThread = NULL;
+    mMutex = NULL;
+}
+
+// Start loading [file] with [load] in a worker thread
+void AsyncLoad::start(LoadFunction load, const char *file)
+{
+    mLoad = load;
+    mFile = file;
+    mResult = NULL;
+    mDone = false;
+    mMutex = SDL_CreateMutex();
+    mThread = (mMutex != NULL)? SDL_CreateThread(run, this) : NULL;
+    if (mThread == NULL)
+    {
+        mResult = mLoad(mFile);
+        mDone = true;
+    }
+}
+
+// Worker thread
+int AsyncLoad::run(void *data)
+{
+    AsyncLoad *self = (AsyncLoad *)data;
+    STC_TRACE_THREAD("loader");
+    void *result;
+    {
+        STC_TRACE_SPAN("load");
+        result = self->mLoad(self->mFile);
+    }
+
+    SDL_mutexP(self->mMutex);
+    self->mResult = result;
+    self->mDone = true;
+    SDL_mutexV(self->mMutex);
+    return 0;
+}
+
+// Return true if the worker has finished and the result wasn't taken
+bool AsyncLoad::isDone()
+{
+    if (mThread == NULL)
+    {
+        return mDone;
+    }
+    SDL_mutexP(mMutex);
+    bool done = mDone;
+    SDL_mutexV(mMutex);
+    return done;
+}
+
+// Return true if the load was started and the result wasn't taken
+bool AsyncLoad::isPending() const
+{
+    return mLoad != NULL;
+}
+
+// Wait for the worker and return the loaded object
+void *AsyncLoad::take()
+{
+    if (mThread != NULL)
+    {
+        SDL_WaitThread(mThread, NULL);
+        mThread = NULL;
+    }
+    if (mMutex != NULL)
+    {
+        SDL_DestroyMutex(mMutex);
+        mMutex = NULL;
+    }
+    void *result = mResult;
+    mLoad = NULL;
+    mResult = NULL;
+    mDone = false;
+    return result;
+}
+}
@@ -0,0 +1,59 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Loading of asset files in worker threads.                                */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#ifndef STC_SDL_LOADER_HPP_
+#define STC_SDL_LOADER_HPP_
+
+#include <SDL.h>
+#include <SDL_thread.h>
+#include "../trace.hpp"
+
+namespace stc
+{
+
+// Loads a file in a worker thread. If the thread can't be created the file
+// is loaded when the load is started.
+class AsyncLoad
+{
+public:
+    // Function that loads a file, it returns NULL on error
+    typedef void *(*LoadFunction)(const char *file);
+
+    AsyncLoad();
+
+    // Start loading [file] with [load]
+    void start(LoadFunction load, const char *file);
+
+    // Return true if the file was loaded (or it failed) and it wasn't taken,
+    // it doesn't wait
+    bool isDone();
+
+    // Return true if the load was started and its result wasn't taken, the
+    // worker may still be loading
+    bool isPending() const;
+
+    // Wait for the file and return the loaded object, it can be taken only
+    // once, later calls return NULL
+    void *take();
+
+private:
+
+    LoadFunction mLoad;
+    const char  *mFile;
+    void        *mResult;
+    bool         mDone;
+    SDL_Thread  *mThread;
+    SDL_mutex   *mMutex;
+
+    static int run(void *data);
+};
+}
+
+#endif // STC_SDL_LOADER_HPP_
@@ -0,0 +1,372 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   SDL spectator mode, many games played by the computer in one window.     */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "sdl_spectator.hpp"
+#include <cstdlib>
+#include <ctime>
+#include <SDL_image.h>
+
+namespace stc
+{
+
+// Size of the tiles in the tiles image
+static const int IMAGE_TILE_SIZE = 12;
+
+//------------------------------------------------------------------------------
+// Spectator board
+
+int SpectatorBoard::init(Game *game)
+{
+    mGame = game;
+    mPlayer.reset();
+    return Game::ERROR_NONE;
+}
+
+void SpectatorBoard::end()
+{
+}
+
+// The computer plays the game
+void SpectatorBoard::processEvents()
+{
+    mPlayer.play(*mGame);
+}
+
+// Boards are rendered by the spectator after updating all the games
+void SpectatorBoard::renderGame()
+{
+}
+
+long SpectatorBoard::getSystemTime()
+{
+    return SDL_GetTicks();
+}
+
+int SpectatorBoard::random()
+{
+    return rand();
+}
+
+void SpectatorBoard::onLineCompleted()
+{
+}
+
+void SpectatorBoard::onPieceDrop()
+{
+}
+
+//------------------------------------------------------------------------------
+// Spectator
+
+SpectatorSdl::SpectatorSdl()
+{
+    mCount = 0;
+    mGames = NULL;
+    mBoards = NULL;
+    mDirtyRects = NULL;
+    mScreen = NULL;
+    mBmpTiles = NULL;
+    mBmpNumbers = NULL;
+}
+
+// Start the games and create the window, if there are no problems returns ERROR_NONE
+int SpectatorSdl::init(int count)
+{
+    if (count < MIN_BOARDS || count > MAX_BOARDS)
+    {
+        return Game::ERROR_PLATFORM;
+    }
+    srand((unsigned int)(time(NULL)));
+
+    if (SDL_Init(SDL_INIT_VIDEO) < 0)
+    {
+        return Game::ERROR_PLATFORM;
+    }
+
+    // Boards are taller than wide, use about twice columns than rows
+    mCount = count;
+    mColumns = 1;
+    while (mColumns * mColumns < 2 * mCount)
+    {
+        ++mColumns;
+    }
+    if (mColumns > mCount)
+    {
+        mColumns = mCount;
+    }
+    int rows = (mCount + mColumns - 1) / mColumns;
+
+    mScreen = SDL_SetVideoMode(mColumns * CELL_WIDTH + BOARD_SPACING,
+                               rows * CELL_HEIGHT + BOARD_SPACING,
+                               SCREEN_BIT_DEPTH, SDL_SWSURFACE);
+    if (mScreen == NULL)
+    {
+        return Game::ERROR_NO_VIDEO;
+    }
+    SDL_WM_SetCaption(STC_GAME_NAME " (spectator)", STC_GAME_NAME);
+
+    // All the boards share the same images
+    SDL_Surface *image = IMG_Load_RW(AssetsSdl::open(STC_BMP_TILE_BLOCKS), 1);
+    if (image == NULL)
+    {
+        return Game::ERROR_NO_IMAGES;
+    }
+    mBmpTiles = createTiles(image);
+    SDL_FreeSurface(image);
+    mBmpNumbers = PlatformSdl::loadImage(STC_BMP_NUMBERS, false);
+    if (mBmpTiles == NULL || mBmpNumbers == NULL)
+    {
+        return Game::ERROR_NO_IMAGES;
+    }
+    mBoardColor = SDL_MapRGB(mScreen->format, 0x10, 0x10, 0x18);
+    SDL_FillRect(mScreen, NULL, SDL_MapRGB(mScreen->format, 0, 0, 0));
+    SDL_UpdateRect(mScreen, 0, 0, 0, 0);
+
+    // Start the games, they are drawn in the first frame
+    mGames = new Game[mCount];
+    mBoards = new SpectatorBoard[mCount];
+    mDirtyRects = new SDL_Rect[mCount];
+    for (int i = 0; i < mCount; ++i)
+    {
+        mGames[i].init(&mBoards[i]);
+        if (mGames[i].errorCode() != Game::ERROR_NONE)
+        {
+            return mGames[i].errorCode();
+        }
+    }
+    return Game::ERROR_NONE;
+}
+
+// Create the tiles image scaled down to the spectator tile size, return NULL on error
+SDL_Surface* SpectatorSdl::createTiles(SDL_Surface *image)
+{
+    // The scaling below reads and writes whole 32 bit pixels
+    SDL_Surface *source = SDL_DisplayFormat(image);
+    if (source == NULL)
+    {
+        return NULL;
+    }
+    if (source->format->BytesPerPixel != 4)
+    {
+        SDL_FreeSurface(source);
+        return NULL;
+    }
+    int tiles = (source->w - 1) / IMAGE_TILE_SIZE;
+    SDL_Surface *scaled = SDL_CreateRGBSurface(SDL_SWSURFACE,
+                                               TILE_SIZE * tiles + 1, 2 * (TILE_SIZE + 1),
+                                               source->format->BitsPerPixel,
+                                               source->format->Rmask,
+                                               source->format->Gmask,
+                                               source->format->Bmask,
+                                               source->format->Amask);
+    if (scaled == NULL)
+    {
+        SDL_FreeSurface(source);
+        return NULL;
+    }
+
+    // Nearest pixel scaling, tiles keep the border shared with the next tile
+    SDL_LockSurface(source);
+    SDL_LockSurface(scaled);
+    for (int y = 0; y < scaled->h; ++y)
+    {
+        int row = y / (TILE_SIZE + 1);
+        int sourceY = (IMAGE_TILE_SIZE + 1) * row + (y % (TILE_SIZE + 1)) * IMAGE_TILE_SIZE / TILE_SIZE;
+        if (sourceY > source->h - 1)
+        {
+            sourceY = source->h - 1;
+        }
+        const Uint32 *sourcePixels = (const Uint32 *)((const Uint8 *)source->pixels + sourceY * source->pitch);
+        Uint32 *pixels = (Uint32 *)((Uint8 *)scaled->pixels + y * scaled->pitch);
+        for (int x = 0; x < scaled->w; ++x)
+        {
+            int sourceX = x * IMAGE_TILE_SIZE / TILE_SIZE;
+            if (sourceX > source->w - 1)
+            {
+                sourceX = source->w - 1;
+            }
+            pixels[x] = sourcePixels[sourceX];
+        }
+    }
+    SDL_UnlockSurface(scaled);
+    SDL_UnlockSurface(source);
+
+    if ((source->flags & SDL_SRCCOLORKEY) != 0)
+    {
+        SDL_SetColorKey(scaled, SDL_SRCCOLORKEY | SDL_RLEACCEL, source->format->colorkey);
+    }
+    SDL_FreeSurface(source);
+    return scaled;
+}
+
+// Return false if the window was closed
+bool SpectatorSdl::processEvents()
+{
+    SDL_Event event;
+    while (SDL_PollEvent(&event))
+    {
+        if ((event.type == SDL_QUIT)
+                || ((event.type == SDL_KEYDOWN) && (event.key.keysym.sym == SDLK_ESCAPE)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Update and render all the games until the window is closed
+void SpectatorSdl::run()
+{
+    while (processEvents())
+    {
+        Uint32 frameStart = SDL_GetTicks();
+        int dirtyCount = 0;
+
+        for (int i = 0; i < mCount; ++i)
+        {
+            Game &game = mGames[i];
+            game.update();
+
+            // Only the boards of the changed games are redrawn
+            if (game.hasChanged())
+            {
+                SDL_Rect &rect = mDirtyRects[dirtyCount++];
+                rect.x = (Sint16)(BOARD_SPACING + CELL_WIDTH * (i % mColumns));
+                rect.y = (Sint16)(BOARD_SPACING + CELL_HEIGHT * (i / mColumns));
+                rect.w = BOARD_WIDTH;
+                rect.h = BOARD_HEIGHT + SCORE_GAP + NUMBER_HEIGHT;
+                drawBoard(game, rect.x, rect.y);
+                game.onChangeProcessed();
+            }
+        }
+        if (dirtyCount > 0)
+        {
+            SDL_UpdateRects(mScreen, dirtyCount, mDirtyRects);
+        }
+
+        // Resting until the next frame
+        Uint32 elapsed = SDL_GetTicks() - frameStart;
+        if (elapsed < (Uint32)FRAME_TIME)
+        {
+            SDL_Delay(FRAME_TIME - elapsed);
+        }
+    }
+}
+
+// Draw the board of a game and its score with the up-left corner on the given position
+void SpectatorSdl::drawBoard(Game &game, int x, int y)
+{
+    SDL_Rect rect;
+    rect.x = (Sint16)x;
+    rect.y = (Sint16)y;
+    rect.w = BOARD_WIDTH;
+    rect.h = BOARD_HEIGHT + SCORE_GAP + NUMBER_HEIGHT;
+    SDL_FillRect(mScreen, &rect, SDL_MapRGB(mScreen->format, 0, 0, 0));
+    rect.h = BOARD_HEIGHT;
+    SDL_FillRect(mScreen, &rect, mBoardColor);
+
+    for (int i = 0; i < Game::BOARD_TILEMAP_WIDTH; ++i)
+    {
+        for (int j = 0; j < Game::BOARD_TILEMAP_HEIGHT; ++j)
+        {
+            if (game.getCell(i, j) != Game::EMPTY_CELL)
+            {
+                drawTile(x + TILE_SIZE * i, y + TILE_SIZE * j, game.getCell(i, j), false);
+            }
+        }
+    }
+    const Game::StcTetromino &block = game.fallingBlock();
+#ifdef STC_SHOW_GHOST_PIECE
+    if (game.showShadow() && game.shadowGap() > 0)
+    {
+        drawTetromino(x + TILE_SIZE * block.x, y + TILE_SIZE * (block.y + game.shadowGap()),
+                      block, true);
+    }
+#endif
+    drawTetromino(x + TILE_SIZE * block.x, y + TILE_SIZE * block.y, block, false);
+
+    // The number is drawn from its right side, like in the game screen
+    drawNumber(x - NUMBER_WIDTH, y + BOARD_HEIGHT + SCORE_GAP, game.stats().score,
+               SCORE_LENGTH, Game::COLOR_WHITE);
+}
+
+// Draw the cells of a tetromino with its up-left corner on the given position
+void SpectatorSdl::drawTetromino(int x, int y, const Game::StcTetromino &block, bool shadow)
+{
+    for (int i = 0; i < Game::TETROMINO_SIZE; ++i)
+    {
+        for (int j = 0; j < Game::TETROMINO_SIZE; ++j)
+        {
+            if (block.cells[i][j] != Game::EMPTY_CELL)
+            {
+                drawTile(x + (TILE_SIZE * i), y + (TILE_SIZE * j), block.cells[i][j], shadow);
+            }
+        }
+    }
+}
+
+// Draw a scaled tile
+void SpectatorSdl::drawTile(int x, int y, int tile, bool shadow)
+{
+    SDL_Rect recDestine;
+    SDL_Rect recSource;
+
+    recDestine.x = (Sint16)x;
+    recDestine.y = (Sint16)y;
+    recSource.x = (Sint16)(TILE_SIZE * tile);
+    recSource.y = (TILE_SIZE + 1) * (shadow? 1 : 0);
+    recSource.w = TILE_SIZE + 1;
+    recSource.h = TILE_SIZE + 1;
+    SDL_BlitSurface(mBmpTiles, &recSource, mScreen, &recDestine);
+}
+
+// Draw a number on the given position
+void SpectatorSdl::drawNumber(int x, int y, long number, int length, int color)
+{
+    SDL_Rect recDestine;
+    SDL_Rect recSource;
+
+    recSource.y = (Sint16)(NUMBER_HEIGHT * color);
+    recSource.w = NUMBER_WIDTH;
+    recSource.h = NUMBER_HEIGHT;
+    recDestine.y = (Sint16)y;
+
+    int pos = 0;
+    do
+    {
+        recDestine.x = (Sint16)(x + NUMBER_WIDTH * (length - pos));
+        recSource.x = (Sint16)(NUMBER_WIDTH * (number % 10));
+        SDL_BlitSurface(mBmpNumbers, &recSource, mScreen, &recDestine);
+        number /= 10;
+    } while (++pos < length);
+}
+
+// Release the games and the window
+void SpectatorSdl::end()
+{
+    if (mGames != NULL)
+    {
+        for (int i = 0; i < mCount; ++i)
+        {
+            mGames[i].end();
+        }
+    }
+    delete[] mGames;
+    delete[] mBoards;
+    delete[] mDirtyRects;
+    mGames = NULL;
+    mBoards = NULL;
+    mDirtyRects = NULL;
+
+    SDL_FreeSurface(mBmpTiles);
+    SDL_FreeSurface(mBmpNumbers);
+    SDL_Quit();
+}
+}
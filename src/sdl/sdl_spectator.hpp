@@ -0,0 +1,114 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Constants and definitions for the SDL spectator mode.                    */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "sdl_game.hpp"
+
+#ifndef STC_SDL_SPECTATOR_HPP_
+#define STC_SDL_SPECTATOR_HPP_
+
+#include "../ai/ai_player.hpp"
+
+namespace stc
+{
+
+// Platform of a game shown by the spectator. The game is played by the
+// computer, it has no sound and it's rendered by the spectator.
+class SpectatorBoard : public Platform
+{
+public:
+    virtual int init(Game *game);
+    virtual void end();
+    virtual void processEvents();
+    virtual void renderGame();
+    virtual long getSystemTime();
+    virtual int random();
+    virtual void onLineCompleted();
+    virtual void onPieceDrop();
+
+private:
+    Game*    mGame;
+    AiPlayer mPlayer;
+};
+
+// Shows many games in a grid in one window. All the games are updated in
+// the same frame loop and a board is only redrawn when its game changed.
+class SpectatorSdl
+{
+public:
+    // Number of games shown
+    static const int MIN_BOARDS = 1;
+    static const int MAX_BOARDS = 64;
+
+    // UI layout (quantities are expressed in pixels)
+
+    // Size of square tile, the tiles of the game are scaled down to it
+    static const int TILE_SIZE = 6;
+
+    // Size of a board
+    static const int BOARD_WIDTH  = TILE_SIZE * Game::BOARD_TILEMAP_WIDTH + 1;
+    static const int BOARD_HEIGHT = TILE_SIZE * Game::BOARD_TILEMAP_HEIGHT + 1;
+
+    // Score shown below every board
+    static const int SCORE_LENGTH = 8;
+    static const int SCORE_GAP    = 2;
+
+    // Size of number
+    static const int NUMBER_WIDTH  = 7;
+    static const int NUMBER_HEIGHT = 9;
+
+    // Space between boards
+    static const int BOARD_SPACING = 6;
+
+    // Size of the grid cell used by a board and its score
+    static const int CELL_WIDTH  = BOARD_WIDTH + BOARD_SPACING;
+    static const int CELL_HEIGHT = BOARD_HEIGHT + SCORE_GAP + NUMBER_HEIGHT + BOARD_SPACING;
+
+    // Use 32 bits per pixel
+    static const int SCREEN_BIT_DEPTH = 32;
+
+    // Frame time (in milliseconds), about 60 frames per second
+    static const int FRAME_TIME = 16;
+
+    SpectatorSdl();
+
+    // Start [count] games and create the window, return ERROR_NONE on success
+    int init(int count);
+
+    // Update and render all the games until the window is closed
+    void run();
+
+    // Release the games and the window
+    void end();
+
+private:
+
+    int              mCount;
+    int              mColumns;
+    Game*            mGames;
+    SpectatorBoard*  mBoards;
+
+    SDL_Surface* mScreen;
+    SDL_Surface* mBmpTiles;
+    SDL_Surface* mBmpNumbers;
+    Uint32       mBoardColor;
+
+    // Screen regions of the boards redrawn in the current frame
+    SDL_Rect* mDirtyRects;
+
+    bool processEvents();
+    void drawBoard(Game &game, int x, int y);
+    void drawTetromino(int x, int y, const Game::StcTetromino &block, bool shadow);
+    void drawTile(int x, int y, int tile, bool shadow);
+    void drawNumber(int x, int y, long number, int length, int color);
+    SDL_Surface* createTiles(SDL_Surface *image);
+};
+}
+
+#endif // STC_SDL_SPECTATOR_HPP_
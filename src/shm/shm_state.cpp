@@ -0,0 +1,289 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Game state shared with other processes (bots) through a POSIX shared     */
+/*   memory segment.                                                          */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "shm_state.hpp"
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Memory barrier between the writes of the shared data and its index
+#if defined(__GNUC__)
+#define STC_SHM_BARRIER() __sync_synchronize()
+#elif defined(_MSC_VER)
+#include <intrin.h>
+#define STC_SHM_BARRIER() _ReadWriteBarrier()
+#endif
+
+namespace stc
+{
+
+SharedState::SharedState()
+{
+    mState = NULL;
+    mName[0] = '\0';
+    mOwner = false;
+    mTick = 0;
+}
+
+SharedState::~SharedState()
+{
+    close();
+}
+
+// Create the segment [name], it replaces an old one with the same name
+bool SharedState::create(const char *name)
+{
+    if (!map(name, true))
+    {
+        return false;
+    }
+    memset(mState, 0, sizeof(StcSharedState));
+    mState->version = VERSION;
+    mState->snapshotCount = SNAPSHOT_COUNT;
+    mState->inputCapacity = INPUT_CAPACITY;
+    mTick = 0;
+
+    // Readers check the magic last
+    STC_SHM_BARRIER();
+    mState->magic = MAGIC;
+    return true;
+}
+
+// Attach to the segment [name], fail if it isn't a game segment
+bool SharedState::attach(const char *name)
+{
+    if (!map(name, false))
+    {
+        return false;
+    }
+    if (mState->magic != MAGIC || mState->version != VERSION)
+    {
+        close();
+        return false;
+    }
+    STC_SHM_BARRIER();
+    return true;
+}
+
+#ifndef _WIN32
+
+// Open the segment and map it
+bool SharedState::map(const char *name, bool create)
+{
+    close();
+    if (strlen(name) >= sizeof(mName))
+    {
+        return false;
+    }
+    if (create)
+    {
+        shm_unlink(name);
+    }
+    int fd = shm_open(name, create? (O_RDWR | O_CREAT | O_EXCL) : O_RDWR, 0600);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat info;
+    if ((create && ftruncate(fd, sizeof(StcSharedState)) != 0)
+        || fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(StcSharedState))
+    {
+        ::close(fd);
+        if (create)
+        {
+            shm_unlink(name);
+        }
+        return false;
+    }
+
+    void *memory = mmap(NULL, sizeof(StcSharedState), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (memory == MAP_FAILED)
+    {
+        if (create)
+        {
+            shm_unlink(name);
+        }
+        return false;
+    }
+    mState = (StcSharedState *)memory;
+    strcpy(mName, name);
+    mOwner = create;
+    return true;
+}
+
+// Unmap the segment, the game also removes it
+void SharedState::close()
+{
+    if (mState == NULL)
+    {
+        return;
+    }
+    munmap(mState, sizeof(StcSharedState));
+    if (mOwner)
+    {
+        shm_unlink(mName);
+    }
+    mState = NULL;
+    mOwner = false;
+}
+
+#else // _WIN32
+
+// Shared memory segments are only supported on POSIX systems
+bool SharedState::map(const char *, bool)
+{
+    return false;
+}
+
+void SharedState::close()
+{
+    mState = NULL;
+}
+
+#endif // _WIN32
+
+// Write a snapshot of [game] in the next slot of the ring. The sequence of
+// the slot is odd while it is written, a reader copying it at the same time
+// sees a different sequence before and after the copy and tries again.
+void SharedState::publish(Game &game)
+{
+    if (mState == NULL)
+    {
+        return;
+    }
+    ++mTick;
+    StcSharedSnapshot &snapshot = mState->snapshots[mTick % SNAPSHOT_COUNT];
+    uint32_t sequence = snapshot.sequence + 1;
+    snapshot.sequence = sequence;
+    STC_SHM_BARRIER();
+
+    snapshot.tick = mTick;
+    for (int j = 0; j < Game::BOARD_TILEMAP_HEIGHT; ++j)
+    {
+        uint32_t row = 0;
+        for (int i = 0; i < Game::BOARD_TILEMAP_WIDTH; ++i)
+        {
+            if (game.getCell(i, j) != Game::EMPTY_CELL)
+            {
+                row |= 1u << i;
+            }
+        }
+        snapshot.rows[j] = row;
+    }
+
+    const Game::StcTetromino &falling = game.fallingBlock();
+    uint16_t cells = 0;
+    for (int i = 0; i < Game::TETROMINO_SIZE; ++i)
+    {
+        for (int j = 0; j < Game::TETROMINO_SIZE; ++j)
+        {
+            if (falling.cells[i][j] != Game::EMPTY_CELL)
+            {
+                cells |= (uint16_t)(1u << (i + Game::TETROMINO_SIZE * j));
+            }
+        }
+    }
+    snapshot.fallingCells = cells;
+    snapshot.fallingType = (int8_t)falling.type;
+    snapshot.fallingX = (int8_t)falling.x;
+    snapshot.fallingY = (int8_t)falling.y;
+    snapshot.fallingSize = (int8_t)falling.size;
+    snapshot.nextType = (int8_t)game.nextBlock().type;
+    snapshot.flags = (uint8_t)((game.isOver()? SNAPSHOT_OVER : 0)
+                               | (game.isPaused()? SNAPSHOT_PAUSED : 0));
+    snapshot.score = game.stats().score;
+    snapshot.lines = game.stats().lines;
+    snapshot.level = game.stats().level;
+    snapshot.totalPieces = game.stats().totalPieces;
+
+    STC_SHM_BARRIER();
+    snapshot.sequence = sequence + 1;
+    STC_SHM_BARRIER();
+    mState->latest = mTick;
+}
+
+// Copy the newest snapshot, if the game overwrites it during the copy read
+// the newest one again
+bool SharedState::readLatest(StcSharedSnapshot *snapshot)
+{
+    if (mState == NULL)
+    {
+        return false;
+    }
+    for (;;)
+    {
+        uint32_t latest = mState->latest;
+        if (latest == 0)
+        {
+            return false;
+        }
+        StcSharedSnapshot &slot = mState->snapshots[latest % SNAPSHOT_COUNT];
+        uint32_t sequence = slot.sequence;
+        STC_SHM_BARRIER();
+        memcpy(snapshot, (const void *)&slot, sizeof(StcSharedSnapshot));
+        STC_SHM_BARRIER();
+        if ((sequence & 1) == 0 && slot.sequence == sequence && snapshot->tick == latest)
+        {
+            return true;
+        }
+    }
+}
+
+// Send a key press or release, return false if the ring is full
+bool SharedState::pushInput(bool press, int event)
+{
+    if (mState == NULL)
+    {
+        return false;
+    }
+    uint32_t head = mState->inputHead;
+    if (head - mState->inputTail == (uint32_t)INPUT_CAPACITY)
+    {
+        return false;
+    }
+    mState->inputs[head % INPUT_CAPACITY] = (uint32_t)event | (press? INPUT_PRESS : 0);
+
+    // The input must be written before it is published
+    STC_SHM_BARRIER();
+    mState->inputHead = head + 1;
+    return true;
+}
+
+// Take the oldest input, return false if there is none
+bool SharedState::popInput(bool *press, int *event)
+{
+    if (mState == NULL)
+    {
+        return false;
+    }
+    uint32_t tail = mState->inputTail;
+    if (tail == mState->inputHead)
+    {
+        return false;
+    }
+    STC_SHM_BARRIER();
+    uint32_t input = mState->inputs[tail % INPUT_CAPACITY];
+    *press = (input & INPUT_PRESS) != 0;
+    *event = (int)(input & ~INPUT_PRESS);
+
+    // Free the slot only after reading it
+    STC_SHM_BARRIER();
+    mState->inputTail = tail + 1;
+    return true;
+}
+}
@@ -0,0 +1,137 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Game state shared with other processes (bots) through a POSIX shared     */
+/*   memory segment. The game writes snapshots in a ring protected by         */
+/*   sequence locks, the bot reads them without system calls and sends its    */
+/*   key presses back through a second ring.                                  */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#ifndef STC_SHM_STATE_HPP_
+#define STC_SHM_STATE_HPP_
+
+#include "../game.hpp"
+#include <stdint.h>
+
+namespace stc
+{
+
+struct StcSharedSnapshot;
+struct StcSharedState;
+
+// One side of a shared state segment. The game creates the segment and
+// publishes a snapshot every frame, a bot attaches to it, reads the newest
+// snapshot and pushes inputs. Every ring has a single writer.
+class SharedState
+{
+public:
+    static const uint32_t MAGIC   = 0x53544353; // "STCS"
+    static const uint32_t VERSION = 1;
+
+    static const int SNAPSHOT_COUNT = 16;
+    static const int INPUT_CAPACITY = 64;
+
+    // Snapshot flags
+    static const uint8_t SNAPSHOT_OVER   = 1;
+    static const uint8_t SNAPSHOT_PAUSED = 1 << 1;
+
+    // Input flag of a key press
+    static const uint32_t INPUT_PRESS = 0x80000000u;
+
+    SharedState();
+    ~SharedState();
+
+    // Create the segment [name] (like "/stc"), used by the game
+    bool create(const char *name);
+
+    // Attach to the segment [name] created by a game, used by the bot
+    bool attach(const char *name);
+
+    // Unmap the segment, the game also removes it
+    void close();
+
+    bool isOpen()   { return mState != NULL; }
+
+    // Write a snapshot of [game] as the newest one
+    void publish(Game &game);
+
+    // Copy the newest snapshot, return false if there is none yet
+    bool readLatest(StcSharedSnapshot *snapshot);
+
+    // Send a key press or release, return false if the ring is full
+    bool pushInput(bool press, int event);
+
+    // Take the oldest input, return false if there is none
+    bool popInput(bool *press, int *event);
+
+private:
+
+    StcSharedState *mState;
+    char  mName[64];
+    bool  mOwner;      // the segment was created here
+    uint32_t mTick;
+
+    bool map(const char *name, bool create);
+
+    // Not copyable
+    SharedState(const SharedState &);
+    SharedState &operator=(const SharedState &);
+};
+
+// Snapshot of the game state. Integers use the byte order of the machine.
+struct StcSharedSnapshot
+{
+    volatile uint32_t sequence; // odd while the snapshot is being written
+    uint32_t tick;              // number of the frame, from 1
+
+    // Locked cells, bit i of row j is set if the cell (i, j) is filled.
+    // Row 0 is the top of the board.
+    uint32_t rows[Game::BOARD_TILEMAP_HEIGHT];
+
+    // Falling tetromino, bit (x + 4 * y) of cells is set if the cell (x, y)
+    // of its buffer is filled, its buffer is at (fallingX, fallingY)
+    uint16_t fallingCells;
+    int8_t   fallingType;
+    int8_t   fallingX;
+    int8_t   fallingY;
+    int8_t   fallingSize;
+    int8_t   nextType;
+    uint8_t  flags;             // SharedState::SNAPSHOT_* bits
+
+    int64_t  score;
+    int32_t  lines;
+    int32_t  level;
+    int32_t  totalPieces;
+    int32_t  padding;
+};
+
+// Layout of the shared memory segment
+struct StcSharedState
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t snapshotCount;
+    uint32_t inputCapacity;
+
+    // Tick of the newest snapshot, it is in snapshots[latest % snapshotCount]
+    volatile uint32_t latest;
+    uint32_t reserved[11];
+
+    StcSharedSnapshot snapshots[SharedState::SNAPSHOT_COUNT];
+
+    // Key presses of the bot, a Game::EVENT_* value with INPUT_PRESS set
+    // for a press. The bot writes inputHead and the game writes inputTail,
+    // they are on separate cache lines.
+    volatile uint32_t inputHead;
+    uint32_t reservedHead[15];
+    volatile uint32_t inputTail;
+    uint32_t reservedTail[15];
+    uint32_t inputs[SharedState::INPUT_CAPACITY];
+};
+}
+
+#endif // STC_SHM_STATE_HPP_
@@ -0,0 +1,149 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Software rasterizer for 32 bits per pixel images.                        */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "soft_raster.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace stc
+{
+
+// Copy a row of pixels
+static inline void copyRow(uint32_t *target, const uint32_t *source, int count)
+{
+    int i = 0;
+#if defined(__AVX2__)
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i s = _mm256_loadu_si256((const __m256i *)(source + i));
+        _mm256_storeu_si256((__m256i *)(target + i), s);
+    }
+#endif
+#if defined(__SSE2__)
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i s = _mm_loadu_si128((const __m128i *)(source + i));
+        _mm_storeu_si128((__m128i *)(target + i), s);
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        target[i] = source[i];
+    }
+}
+
+// Copy a row of pixels skipping the transparent ones. The vector loops
+// build a mask of the transparent pixels and select between the source
+// and the target pixels, so there are no branches.
+static inline void copyRowMasked(uint32_t *target, const uint32_t *source, int count,
+                                 uint32_t alphaMask)
+{
+    int i = 0;
+#if defined(__AVX2__)
+    __m256i alpha8 = _mm256_set1_epi32((int)alphaMask);
+    __m256i zero8 = _mm256_setzero_si256();
+    for (; i + 8 <= count; i += 8)
+    {
+        __m256i s = _mm256_loadu_si256((const __m256i *)(source + i));
+        __m256i t = _mm256_loadu_si256((const __m256i *)(target + i));
+        __m256i transparent = _mm256_cmpeq_epi32(_mm256_and_si256(s, alpha8), zero8);
+        _mm256_storeu_si256((__m256i *)(target + i), _mm256_blendv_epi8(s, t, transparent));
+    }
+#endif
+#if defined(__SSE2__)
+    __m128i alpha4 = _mm_set1_epi32((int)alphaMask);
+    __m128i zero4 = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128i s = _mm_loadu_si128((const __m128i *)(source + i));
+        __m128i t = _mm_loadu_si128((const __m128i *)(target + i));
+        __m128i transparent = _mm_cmpeq_epi32(_mm_and_si128(s, alpha4), zero4);
+        _mm_storeu_si128((__m128i *)(target + i),
+                         _mm_or_si128(_mm_and_si128(transparent, t),
+                                      _mm_andnot_si128(transparent, s)));
+    }
+#endif
+    for (; i < count; ++i)
+    {
+        if ((source[i] & alphaMask) != 0)
+        {
+            target[i] = source[i];
+        }
+    }
+}
+
+// Clip the area to both images, return false if nothing is left
+bool SoftRaster::clip(const StcImage &target, int &x, int &y,
+                      const StcImage &source, int &sx, int &sy, int &w, int &h)
+{
+    if (sx < 0) { x -= sx; w += sx; sx = 0; }
+    if (sy < 0) { y -= sy; h += sy; sy = 0; }
+    if (x < 0)  { sx -= x; w += x;  x = 0; }
+    if (y < 0)  { sy -= y; h += y;  y = 0; }
+    if (sx + w > source.width)  w = source.width - sx;
+    if (sy + h > source.height) h = source.height - sy;
+    if (x + w > target.width)   w = target.width - x;
+    if (y + h > target.height)  h = target.height - y;
+    return (w > 0) && (h > 0);
+}
+
+// Copy an area of an image to another one
+void SoftRaster::copy(const StcImage &target, int x, int y,
+                      const StcImage &source, int sx, int sy, int w, int h)
+{
+    if (!clip(target, x, y, source, sx, sy, w, h))
+    {
+        return;
+    }
+    uint32_t *row = target.pixels + y * target.pitch + x;
+    const uint32_t *sourceRow = source.pixels + sy * source.pitch + sx;
+    for (int j = 0; j < h; ++j)
+    {
+        copyRow(row, sourceRow, w);
+        row += target.pitch;
+        sourceRow += source.pitch;
+    }
+}
+
+// Copy an area of an image to another one skipping transparent pixels
+void SoftRaster::copyMasked(const StcImage &target, int x, int y,
+                            const StcImage &source, int sx, int sy, int w, int h,
+                            uint32_t alphaMask)
+{
+    if (!clip(target, x, y, source, sx, sy, w, h))
+    {
+        return;
+    }
+    uint32_t *row = target.pixels + y * target.pitch + x;
+    const uint32_t *sourceRow = source.pixels + sy * source.pitch + sx;
+    for (int j = 0; j < h; ++j)
+    {
+        copyRowMasked(row, sourceRow, w, alphaMask);
+        row += target.pitch;
+        sourceRow += source.pitch;
+    }
+}
+
+// Name of the instruction set used for copying rows
+const char* SoftRaster::instructionSet()
+{
+#if defined(__AVX2__)
+    return "avx2";
+#elif defined(__SSE2__)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+}
@@ -0,0 +1,58 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Software rasterizer for 32 bits per pixel images.                        */
+/*   It doesn't depend on SDL, so the generated frames are the same on any    */
+/*   platform. Rows are copied with AVX2 or SSE2 when the compiler targets    */
+/*   them (for example with -mavx2), otherwise plain C++ is used.             */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#ifndef STC_SOFT_RASTER_HPP_
+#define STC_SOFT_RASTER_HPP_
+
+#include <stdint.h>
+
+namespace stc
+{
+
+// Image with 32 bits per pixel. Pixels with the alpha bits clear
+// are transparent, they are skipped by masked copies.
+struct StcImage
+{
+    uint32_t *pixels;
+    int width;
+    int height;
+    int pitch;     // pixels from a row to the next one
+};
+
+class SoftRaster
+{
+public:
+
+    // Copy an area of [source] with its up-left corner at (sx, sy) to
+    // (x, y) in [target]. The area is clipped to both images.
+    static void copy(const StcImage &target, int x, int y,
+                     const StcImage &source, int sx, int sy, int w, int h);
+
+    // Like copy but the transparent pixels of [source] are skipped,
+    // [alphaMask] are the bits of the alpha channel.
+    static void copyMasked(const StcImage &target, int x, int y,
+                           const StcImage &source, int sx, int sy, int w, int h,
+                           uint32_t alphaMask);
+
+    // Name of the instruction set used for copying rows
+    static const char* instructionSet();
+
+private:
+
+    // Clip the area to both images, return false if nothing is left
+    static bool clip(const StcImage &target, int &x, int &y,
+                     const StcImage &source, int &sx, int &sy, int &w, int &h);
+};
+}
+
+#endif // STC_SOFT_RASTER_HPP_
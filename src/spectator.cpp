@@ -0,0 +1,33 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Spectator mode, shows many games played by the computer in one window.   */
+/*                                                                            */
+/*   Usage: ./stc++spectator [boards]   (from 1 to 64, 16 by default)         */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "sdl/sdl_spectator.hpp"
+#include <cstdlib>
+
+int main(int argc, char **argv)
+{
+    int boards = (argc > 1)? atoi(argv[1]) : 16;
+
+    // Spectator object
+    stc::SpectatorSdl spectator;
+
+    // Start the games and run them until the window is closed
+    int error = spectator.init(boards);
+    if (error == stc::Game::ERROR_NONE)
+    {
+        spectator.run();
+    }
+    spectator.end();
+
+    // Return to the system
+    return error;
+}
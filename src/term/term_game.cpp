@@ -0,0 +1,523 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   ANSI terminal implementation. (No sound)                                 */
+/*   Using the terminal for game state rendering and user input, only the     */
+/*   characters that changed since the last frame are sent.                   */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "term_game.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cerrno>
+#include <poll.h>
+#include <unistd.h>
+
+namespace stc
+{
+
+// Select graphic rendition sequences of the character attributes.
+// Blocks use the background color, shadows and text the foreground color.
+static const char *const ATTRIBUTE_SEQUENCES[] =
+{
+    "\033[0m",
+    // Blocks: white, cyan, red, blue, orange, green, yellow, purple
+    "\033[0;47m", "\033[0;46m", "\033[0;41m", "\033[0;44m",
+    "\033[0;43m", "\033[0;42m", "\033[0;103m", "\033[0;45m",
+    // Shadows
+    "\033[0;37m", "\033[0;36m", "\033[0;31m", "\033[0;34m",
+    "\033[0;33m", "\033[0;32m", "\033[0;93m", "\033[0;35m"
+};
+
+PlatformTerm::PlatformTerm()
+{
+    mGame = NULL;
+    mAutoPlay = false;
+    mBotCommand = NULL;
+    mRawInput = false;
+}
+
+// Let the computer play the game, call it before init
+void PlatformTerm::setAutoPlay(bool autoPlay)
+{
+    mAutoPlay = autoPlay;
+}
+
+// Let the bot program [command] play the game, call it before init
+void PlatformTerm::setBot(const char *command)
+{
+    mBotCommand = command;
+}
+
+// Initializes platform, if there are no problems returns ERROR_NONE.
+int PlatformTerm::init(Game *game)
+{
+    mGame = game;
+    mPlayer.reset();
+    if (mBotCommand != NULL && !mBot.start(mBotCommand))
+    {
+        return Game::ERROR_PLATFORM;
+    }
+
+    // Initialize the random number generator
+    srand((unsigned int)(time(NULL)));
+
+    // Read keys as soon as they are pressed and without echo
+    if (isatty(STDIN_FILENO) && tcgetattr(STDIN_FILENO, &mSavedTermios) == 0)
+    {
+        struct termios raw = mSavedTermios;
+        raw.c_lflag &= ~(ICANON | ECHO | ISIG);
+        raw.c_cc[VMIN] = 0;
+        raw.c_cc[VTIME] = 0;
+        mRawInput = (tcsetattr(STDIN_FILENO, TCSANOW, &raw) == 0);
+    }
+
+    // Hide the cursor and start with a clear screen
+    mOutput.reserve(4096);
+    mOutput = "\033[?25l";
+    clearScreen();
+    flushOutput();
+    return Game::ERROR_NONE;
+}
+
+// Clear the terminal, the next frame writes every character that is not blank
+void PlatformTerm::clearScreen()
+{
+    for (int y = 0; y < SCREEN_HEIGHT; ++y)
+    {
+        for (int x = 0; x < SCREEN_WIDTH; ++x)
+        {
+            mShown[y][x].glyph = ' ';
+            mShown[y][x].attribute = ATTR_NORMAL;
+        }
+    }
+    mOutput += "\033[0m\033[2J\033[H";
+    mCursorX = 0;
+    mCursorY = 0;
+    mAttribute = ATTR_NORMAL;
+}
+
+// Return the current system time in milliseconds
+long PlatformTerm::getSystemTime()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long)(now.tv_sec * 1000 + now.tv_nsec / 1000000);
+}
+
+// Return a random positive integer number
+int PlatformTerm::random()
+{
+    return rand();
+}
+
+// Send a key press, terminals don't report released keys
+static void sendKey(Game *game, int event)
+{
+    game->onEventStart(event);
+    game->onEventEnd(event);
+}
+
+// Process events and notify game
+void PlatformTerm::processEvents()
+{
+    readKeys();
+    if (mAutoPlay)
+    {
+        mPlayer.play(*mGame);
+    }
+    else if (mBot.isRunning())
+    {
+        mBot.play(*mGame);
+    }
+}
+
+// Read the pressed keys. Arrows and function keys are escape sequences,
+// the escape key is ignored because a sequence may arrive split.
+void PlatformTerm::readKeys()
+{
+    char keys[64];
+    struct pollfd input;
+    input.fd = STDIN_FILENO;
+    input.events = POLLIN;
+
+    while (poll(&input, 1, 0) > 0 && (input.revents & POLLIN) != 0)
+    {
+        ssize_t count = read(STDIN_FILENO, keys, sizeof(keys));
+        if (count <= 0)
+        {
+            return;
+        }
+        for (ssize_t i = 0; i < count; ++i)
+        {
+            if (keys[i] == '\033' && i + 2 < count && (keys[i + 1] == '[' || keys[i + 1] == 'O'))
+            {
+                const char *sequence = keys + i + 2;
+                i += 2;
+                switch (*sequence)
+                {
+                case 'A':
+                    sendKey(mGame, Game::EVENT_ROTATE_CW);
+                    break;
+                case 'B':
+                    sendKey(mGame, Game::EVENT_MOVE_DOWN);
+                    break;
+                case 'C':
+                    sendKey(mGame, Game::EVENT_MOVE_RIGHT);
+                    break;
+                case 'D':
+                    sendKey(mGame, Game::EVENT_MOVE_LEFT);
+                    break;
+                case 'P':
+                    sendKey(mGame, Game::EVENT_PAUSE);
+                    break;
+                case 'Q':
+                    sendKey(mGame, Game::EVENT_SHOW_NEXT);
+                    break;
+#ifdef STC_SHOW_GHOST_PIECE
+                case 'R':
+                    sendKey(mGame, Game::EVENT_SHOW_SHADOW);
+                    break;
+#endif
+                default:
+                    // Numbered keys end with '~', like "\033[15~" for F5
+                    int number = 0;
+                    while (i + 1 < count && keys[i] >= '0' && keys[i] <= '9')
+                    {
+                        number = 10 * number + (keys[i++] - '0');
+                    }
+                    if (number == 11)
+                    {
+                        sendKey(mGame, Game::EVENT_PAUSE);
+                    }
+                    else if (number == 12)
+                    {
+                        sendKey(mGame, Game::EVENT_SHOW_NEXT);
+                    }
+#ifdef STC_SHOW_GHOST_PIECE
+                    else if (number == 13)
+                    {
+                        sendKey(mGame, Game::EVENT_SHOW_SHADOW);
+                    }
+#endif
+                    else if (number == 15)
+                    {
+                        sendKey(mGame, Game::EVENT_RESTART);
+                    }
+                    break;
+                }
+                continue;
+            }
+            switch (keys[i])
+            {
+            case 'q':
+            case 3:     // Ctrl-C
+                sendKey(mGame, Game::EVENT_QUIT);
+                break;
+            case 's':
+                sendKey(mGame, Game::EVENT_MOVE_DOWN);
+                break;
+            case 'w':
+                sendKey(mGame, Game::EVENT_ROTATE_CW);
+                break;
+            case 'a':
+                sendKey(mGame, Game::EVENT_MOVE_LEFT);
+                break;
+            case 'd':
+                sendKey(mGame, Game::EVENT_MOVE_RIGHT);
+                break;
+            case ' ':
+                sendKey(mGame, Game::EVENT_DROP);
+                break;
+            case 'r':
+                sendKey(mGame, Game::EVENT_RESTART);
+                break;
+            case 'p':
+                sendKey(mGame, Game::EVENT_PAUSE);
+                break;
+            case 'n':
+                sendKey(mGame, Game::EVENT_SHOW_NEXT);
+                break;
+#ifdef STC_SHOW_GHOST_PIECE
+            case 'g':
+                sendKey(mGame, Game::EVENT_SHOW_SHADOW);
+                break;
+#endif
+            case 12:    // Ctrl-L, the terminal screen may be damaged
+                clearScreen();
+                composeFrame();
+                flushFrame();
+                break;
+            default:
+                break;
+            }
+        }
+    }
+}
+
+// Put a text in the grid, clipped to the grid width
+void PlatformTerm::putText(int x, int y, const char *text, int attribute)
+{
+    for (; *text != '\0' && x < SCREEN_WIDTH; ++text, ++x)
+    {
+        mScreen[y][x].glyph = *text;
+        mScreen[y][x].attribute = (unsigned char)attribute;
+    }
+}
+
+// Put a number right aligned in a field of [length] characters
+void PlatformTerm::putNumber(int x, int y, long number, int length, int attribute)
+{
+    char text[24];
+    snprintf(text, sizeof(text), "%*ld", length, number);
+    putText(x, y, text, attribute);
+}
+
+// Put a board cell
+void PlatformTerm::putTile(int x, int y, int tile, bool shadow)
+{
+    const char *glyphs = shadow? "::" : "  ";
+    putText(x, y, glyphs, (shadow? ATTR_SHADOW : ATTR_BLOCK) + tile);
+}
+
+// Put the cells of a tetromino with its up-left corner on the given position
+void PlatformTerm::putTetromino(int x, int y, const Game::StcTetromino &block, bool shadow)
+{
+    for (int i = 0; i < Game::TETROMINO_SIZE; ++i)
+    {
+        for (int j = 0; j < Game::TETROMINO_SIZE; ++j)
+        {
+            if (block.cells[i][j] != Game::EMPTY_CELL)
+            {
+                putTile(x + CELL_WIDTH * i, y + j, block.cells[i][j], shadow);
+            }
+        }
+    }
+}
+
+// Compose the state of the game in the grid
+void PlatformTerm::composeFrame()
+{
+    int i, j;
+
+    // Clear the grid and draw the board borders
+    for (j = 0; j < SCREEN_HEIGHT; ++j)
+    {
+        for (i = 0; i < SCREEN_WIDTH; ++i)
+        {
+            mScreen[j][i].glyph = ' ';
+            mScreen[j][i].attribute = ATTR_NORMAL;
+        }
+    }
+    for (j = 0; j < Game::BOARD_TILEMAP_HEIGHT; ++j)
+    {
+        putText(BOARD_X - 1, BOARD_Y + j, "|", ATTR_NORMAL);
+        putText(BOARD_X + CELL_WIDTH * Game::BOARD_TILEMAP_WIDTH, BOARD_Y + j, "|", ATTR_NORMAL);
+    }
+    for (i = -1; i <= CELL_WIDTH * Game::BOARD_TILEMAP_WIDTH; ++i)
+    {
+        putText(BOARD_X + i, BOARD_Y + Game::BOARD_TILEMAP_HEIGHT, "-", ATTR_NORMAL);
+    }
+
+    // Draw the cells in the board, empty cells are dotted to help aiming
+    for (i = 0; i < Game::BOARD_TILEMAP_WIDTH; ++i)
+    {
+        for (j = 0; j < Game::BOARD_TILEMAP_HEIGHT; ++j)
+        {
+            if (mGame->getCell(i, j) != Game::EMPTY_CELL)
+            {
+                putTile(BOARD_X + CELL_WIDTH * i, BOARD_Y + j, mGame->getCell(i, j), false);
+            }
+            else
+            {
+                putText(BOARD_X + CELL_WIDTH * i, BOARD_Y + j, " .", ATTR_NORMAL);
+            }
+        }
+    }
+#ifdef STC_SHOW_GHOST_PIECE
+    // Draw shadow tetromino
+    if (mGame->showShadow() && mGame->shadowGap() > 0)
+    {
+        putTetromino(BOARD_X + CELL_WIDTH * mGame->fallingBlock().x,
+                     BOARD_Y + mGame->fallingBlock().y + mGame->shadowGap(),
+                     mGame->fallingBlock(), true);
+    }
+#endif
+    // Draw falling tetromino
+    putTetromino(BOARD_X + CELL_WIDTH * mGame->fallingBlock().x,
+                 BOARD_Y + mGame->fallingBlock().y, mGame->fallingBlock(), false);
+
+    // Draw preview block
+    putText(STATS_X, PREVIEW_Y - 2, "NEXT", ATTR_NORMAL);
+    if (mGame->showPreview())
+    {
+        putTetromino(PREVIEW_X, PREVIEW_Y, mGame->nextBlock(), false);
+    }
+
+    // Draw game statistic data, hidden on pause
+    putText(STATS_X, STATS_Y, "LEVEL", ATTR_NORMAL);
+    putText(STATS_X, STATS_Y + 2, "LINES", ATTR_NORMAL);
+    putText(STATS_X, STATS_Y + 4, "SCORE", ATTR_NORMAL);
+    putText(PIECES_X, PIECES_Y + 2 * Game::TETROMINO_TYPES, "TOTAL", ATTR_NORMAL);
+
+    static const int pieces[Game::TETROMINO_TYPES] =
+    {
+        Game::TETROMINO_L, Game::TETROMINO_I, Game::TETROMINO_T, Game::TETROMINO_S,
+        Game::TETROMINO_Z, Game::TETROMINO_O, Game::TETROMINO_J
+    };
+    static const int colors[Game::TETROMINO_TYPES] =
+    {
+        Game::COLOR_ORANGE, Game::COLOR_CYAN, Game::COLOR_PURPLE, Game::COLOR_GREEN,
+        Game::COLOR_RED, Game::COLOR_YELLOW, Game::COLOR_BLUE
+    };
+    for (i = 0; i < Game::TETROMINO_TYPES; ++i)
+    {
+        putTile(PIECES_X, PIECES_Y + 2 * i, colors[i], false);
+    }
+
+    if (!mGame->isPaused())
+    {
+        const Game::StcStatics &stats = mGame->stats();
+        putNumber(STATS_X + 6, STATS_Y, stats.level, 10, ATTR_NORMAL);
+        putNumber(STATS_X + 6, STATS_Y + 2, stats.lines, 10, ATTR_NORMAL);
+        putNumber(STATS_X + 6, STATS_Y + 4, stats.score, 10, ATTR_NORMAL);
+        for (i = 0; i < Game::TETROMINO_TYPES; ++i)
+        {
+            putNumber(PIECES_X + 3, PIECES_Y + 2 * i, stats.pieces[pieces[i]], 6, ATTR_NORMAL);
+        }
+        putNumber(PIECES_X + 3, PIECES_Y + 2 * Game::TETROMINO_TYPES + 1, stats.totalPieces, 6, ATTR_NORMAL);
+    }
+    else
+    {
+        putText(BOARD_X + 7, BOARD_Y + Game::BOARD_TILEMAP_HEIGHT / 2, "PAUSED", ATTR_NORMAL);
+    }
+    if (mGame->isOver())
+    {
+        putText(BOARD_X + 5, BOARD_Y + Game::BOARD_TILEMAP_HEIGHT / 2, "GAME OVER", ATTR_NORMAL);
+    }
+}
+
+// Move the cursor to a grid position
+void PlatformTerm::moveCursor(int x, int y)
+{
+    if (y == mCursorY && x == mCursorX)
+    {
+        return;
+    }
+    // Rewrite the cells of a short gap instead of moving
+    if (y == mCursorY && x > mCursorX && x - mCursorX <= MAX_REWRITE_GAP)
+    {
+        while (mCursorX < x)
+        {
+            putCell(mCursorX, y);
+        }
+        return;
+    }
+    char sequence[32];
+    snprintf(sequence, sizeof(sequence), "\033[%d;%dH", y + 1, x + 1);
+    mOutput += sequence;
+    mCursorX = x;
+    mCursorY = y;
+}
+
+// Write a cell of the grid at the cursor position
+void PlatformTerm::putCell(int x, int y)
+{
+    const StcTermCell &cell = mScreen[y][x];
+    if (cell.attribute != mAttribute)
+    {
+        mOutput += ATTRIBUTE_SEQUENCES[cell.attribute];
+        mAttribute = cell.attribute;
+    }
+    mOutput += cell.glyph;
+    mShown[y][x] = cell;
+    ++mCursorX;
+}
+
+// Write the cells that differ from the ones shown by the terminal
+void PlatformTerm::flushFrame()
+{
+    for (int y = 0; y < SCREEN_HEIGHT; ++y)
+    {
+        for (int x = 0; x < SCREEN_WIDTH; ++x)
+        {
+            if (mScreen[y][x].glyph != mShown[y][x].glyph
+                    || mScreen[y][x].attribute != mShown[y][x].attribute)
+            {
+                moveCursor(x, y);
+                putCell(x, y);
+            }
+        }
+    }
+    flushOutput();
+}
+
+// Send the output of the frame to the terminal
+void PlatformTerm::flushOutput()
+{
+    size_t written = 0;
+    while (written < mOutput.size())
+    {
+        ssize_t count = write(STDOUT_FILENO, mOutput.data() + written, mOutput.size() - written);
+        if (count < 0 && errno != EINTR)
+        {
+            break;
+        }
+        written += (count > 0)? (size_t)count : 0;
+    }
+    mOutput.clear();
+}
+
+// Render the state of the game
+void PlatformTerm::renderGame()
+{
+    // Check if the game state has changed, if so redraw
+    if (mGame->hasChanged())
+    {
+        composeFrame();
+        flushFrame();
+
+        // Inform the game that we are done with the changed state
+        mGame->onChangeProcessed();
+    }
+
+    // Resting game
+    if (mGame->profiler() != NULL)
+    {
+        mGame->profiler()->begin(FrameProfiler::PHASE_SLEEP);
+    }
+    struct timespec rest;
+    rest.tv_sec = 0;
+    rest.tv_nsec = SLEEP_TIME * 1000000L;
+    nanosleep(&rest, NULL);
+}
+
+// Restore the terminal
+void PlatformTerm::end()
+{
+    mBot.stop();
+
+    char sequence[32];
+    snprintf(sequence, sizeof(sequence), "\033[0m\033[%d;1H\033[?25h", SCREEN_HEIGHT + 1);
+    mOutput += sequence;
+    flushOutput();
+    if (mRawInput)
+    {
+        tcsetattr(STDIN_FILENO, TCSANOW, &mSavedTermios);
+    }
+}
+
+void PlatformTerm::onLineCompleted()
+{
+}
+
+void PlatformTerm::onPieceDrop()
+{
+}
+}
@@ -0,0 +1,147 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Constants and definitions for the ANSI terminal implementation.          */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#ifndef STC_TERM_GAME_HPP_
+#define STC_TERM_GAME_HPP_
+
+#include "../game.hpp"
+#include "../ai/ai_player.hpp"
+#include "../bot/bot_player.hpp"
+#include <string>
+#include <termios.h>
+
+namespace stc
+{
+
+// Terminal platform implementation, POSIX only.
+// The screen is composed in a character grid and compared with a copy of
+// the last grid sent to the terminal, only the changed cells are written
+// and all the output of a frame is sent with a single write.
+class PlatformTerm : public Platform
+{
+    // Size of the character grid
+    static const int SCREEN_WIDTH  = 64;
+    static const int SCREEN_HEIGHT = Game::BOARD_TILEMAP_HEIGHT + 1;
+
+    // Characters per board cell
+    static const int CELL_WIDTH = 2;
+
+    // Board position (the border is one character to the left)
+    static const int BOARD_X = 22;
+    static const int BOARD_Y = 0;
+
+    // Preview tetromino position
+    static const int PREVIEW_X = 4;
+    static const int PREVIEW_Y = 10;
+
+    // Statistic counters position
+    static const int STATS_X = 2;
+    static const int STATS_Y = 1;
+
+    // Tetromino subtotals position
+    static const int PIECES_X = 48;
+    static const int PIECES_Y = 1;
+
+    // Changed cells closer than this in a row are rewritten together with
+    // the cells between them, it's shorter than moving the cursor
+    static const int MAX_REWRITE_GAP = 4;
+
+    // Sleep time (in milliseconds)
+    static const int SLEEP_TIME = 40;
+
+    // Character attributes
+    enum
+    {
+        ATTR_NORMAL = 0,
+        ATTR_BLOCK  = 1,  // plus the tile color, drawn as background
+        ATTR_SHADOW = 9,  // plus the tile color, drawn as foreground
+        ATTR_COUNT  = 17
+    };
+
+    // Character of the grid
+    struct StcTermCell
+    {
+        char glyph;
+        unsigned char attribute;
+    };
+
+public:
+
+    PlatformTerm();
+
+    // Let the computer play the game
+    void setAutoPlay(bool autoPlay);
+
+    // Let the bot program [command] play the game, call it before init
+    void setBot(const char *command);
+
+    // Initializes platform
+    virtual int init(Game *game);
+
+    // Clear resources used by platform
+    virtual void end();
+
+    // Read input device and notify game
+    virtual void processEvents();
+
+    // Render the state of the game
+    virtual void renderGame();
+
+    // Return the current system time in milliseconds
+    virtual long getSystemTime();
+
+    // Return a random positive integer number
+    virtual int random();
+
+    // Events
+    virtual void onLineCompleted();
+    virtual void onPieceDrop();
+
+private:
+
+    Game *mGame;
+    AiPlayer mPlayer;
+    bool mAutoPlay;
+
+    // External bot, if there is a command for it
+    BotPlayer mBot;
+    const char *mBotCommand;
+
+    // Terminal settings to restore at the end
+    struct termios mSavedTermios;
+    bool mRawInput;
+
+    // Grid of the current frame and grid shown by the terminal
+    StcTermCell mScreen[SCREEN_HEIGHT][SCREEN_WIDTH];
+    StcTermCell mShown[SCREEN_HEIGHT][SCREEN_WIDTH];
+
+    // Terminal state after the last output
+    int mCursorX;
+    int mCursorY;
+    int mAttribute;
+
+    // Output of the current frame
+    std::string mOutput;
+
+    void readKeys();
+    void clearScreen();
+    void putText(int x, int y, const char *text, int attribute);
+    void putNumber(int x, int y, long number, int length, int attribute);
+    void putTile(int x, int y, int tile, bool shadow);
+    void putTetromino(int x, int y, const Game::StcTetromino &block, bool shadow);
+    void composeFrame();
+    void moveCursor(int x, int y);
+    void putCell(int x, int y);
+    void flushFrame();
+    void flushOutput();
+};
+}
+
+#endif // STC_TERM_GAME_HPP_
@@ -0,0 +1,52 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Terminal version, plays in an ANSI terminal (also over ssh).             */
+/*                                                                            */
+/*   Usage: ./stc++term [--ai] [--bot <command>]                              */
+/*   --ai lets the computer play, --bot lets a bot program play (see          */
+/*   bot/bot_player.hpp), for example: ./stc++term --bot ./bot_example        */
+/*   Keys: arrows or wasd, space drops, p pauses, r restarts, q quits.        */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "term/term_game.hpp"
+#include <cstring>
+
+int main(int argc, char **argv)
+{
+    // Game object
+    stc::Game game;
+
+    // Platform object
+    stc::PlatformTerm platform;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--ai") == 0)
+        {
+            platform.setAutoPlay(true);
+        }
+        else if (strcmp(argv[i], "--bot") == 0 && i + 1 < argc)
+        {
+            platform.setBot(argv[++i]);
+        }
+    }
+
+    // Start the game
+    game.init(&platform);
+
+    // Loop until some error happens or the user quits
+    while (game.errorCode() == stc::Game::ERROR_NONE)
+    {
+        game.update();
+    }
+
+    // Game was interrupted or an error happened, end the game
+    game.end();
+
+    // Return to the system
+    return game.errorCode();
+}
@@ -0,0 +1,197 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Example bot for the line protocol of bot/bot_player.hpp.                 */
+/*   For every state it tries all the rotations and columns, rates the        */
+/*   boards like the built-in AI and replies with the best placement.         */
+/*                                                                            */
+/*   Usage: ./stc++term --bot ./bot_example                                   */
+/*          ./bot_match [-g games] ./bot_example                              */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "../ai/ai_player.hpp"
+#include <climits>
+#include <cstdio>
+#include <cstring>
+
+using stc::AiPlayer;
+using stc::Game;
+
+static const int MAX_HEIGHT = 32;
+
+// Board of the state being played
+static int gWidth  = Game::BOARD_TILEMAP_WIDTH;
+static int gHeight = Game::BOARD_TILEMAP_HEIGHT;
+
+// Return the cells of a tetromino rotated clockwise, like the game does
+static unsigned int rotate(unsigned int cells, int size)
+{
+    unsigned int rotated = 0;
+    for (int i = 0; i < size; ++i)
+    {
+        for (int j = 0; j < size; ++j)
+        {
+            if (cells & (1u << (i + 4 * j)))
+            {
+                rotated |= 1u << ((size - j - 1) + 4 * i);
+            }
+        }
+    }
+    return rotated;
+}
+
+// Return true if the tetromino fits on the board at (x, y)
+static bool fits(const unsigned int *rows, unsigned int cells, int x, int y)
+{
+    for (int j = 0; j < 4; ++j)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            if (cells & (1u << (i + 4 * j)))
+            {
+                if (x + i < 0 || x + i >= gWidth || y + j < 0 || y + j >= gHeight
+                        || (rows[y + j] & (1u << (x + i))))
+                {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Rate the board after locking the tetromino at (x, y)
+static int rate(const unsigned int *board, unsigned int cells, int x, int y)
+{
+    unsigned int rows[MAX_HEIGHT];
+    unsigned int filled = (1u << gWidth) - 1;
+    int i, j;
+    memcpy(rows, board, gHeight * sizeof(rows[0]));
+    for (j = 0; j < 4; ++j)
+    {
+        for (i = 0; i < 4; ++i)
+        {
+            if (cells & (1u << (i + 4 * j)))
+            {
+                rows[y + j] |= 1u << (x + i);
+            }
+        }
+    }
+    int lines = 0;
+    for (j = 1; j < gHeight; ++j)
+    {
+        if (rows[j] == filled)
+        {
+            memmove(rows + 1, rows, j * sizeof(rows[0]));
+            ++lines;
+        }
+    }
+
+    int height = 0;
+    int holes = 0;
+    int bumpiness = 0;
+    int lastHeight = 0;
+    for (i = 0; i < gWidth; ++i)
+    {
+        j = 0;
+        while (j < gHeight && !(rows[j] & (1u << i)))
+        {
+            ++j;
+        }
+        int columnHeight = gHeight - j;
+        for (; j < gHeight; ++j)
+        {
+            if (!(rows[j] & (1u << i)))
+            {
+                ++holes;
+            }
+        }
+        height += columnHeight;
+        if (i > 0)
+        {
+            bumpiness += (columnHeight > lastHeight)? columnHeight - lastHeight
+                                                    : lastHeight - columnHeight;
+        }
+        lastHeight = columnHeight;
+    }
+    return AiPlayer::WEIGHT_HEIGHT * height + AiPlayer::WEIGHT_LINES * lines
+           + AiPlayer::WEIGHT_HOLES * holes + AiPlayer::WEIGHT_BUMPINESS * bumpiness;
+}
+
+int main()
+{
+    char line[1024];
+    while (fgets(line, sizeof(line), stdin) != NULL)
+    {
+        if (strncmp(line, "quit", 4) == 0)
+        {
+            break;
+        }
+        if (sscanf(line, "game %d %d", &gWidth, &gHeight) == 2)
+        {
+            if (gHeight > MAX_HEIGHT || gWidth > 32)
+            {
+                fprintf(stderr, "board too big\n");
+                return 1;
+            }
+            continue;
+        }
+
+        unsigned int id, cells;
+        int type, size, x, y, next, length;
+        if (sscanf(line, "state %u %d %d %d %d %d %x%n", &id, &type, &size, &x,
+                   &y, &next, &cells, &length) < 7)
+        {
+            continue;
+        }
+        unsigned int rows[MAX_HEIGHT];
+        const char *text = line + length;
+        for (int j = 0; j < gHeight; ++j)
+        {
+            if (sscanf(text, " %x%n", &rows[j], &length) < 1)
+            {
+                rows[j] = 0;
+                continue;
+            }
+            text += length;
+        }
+
+        int best = INT_MIN;
+        int bestRotation = 0;
+        int bestX = x;
+        unsigned int block = cells;
+        for (int rotation = 0; rotation < 4; ++rotation)
+        {
+            if (rotation > 0)
+            {
+                block = rotate(block, size);
+            }
+            for (int column = -4; column < gWidth; ++column)
+            {
+                if (!fits(rows, block, column, y))
+                {
+                    continue;
+                }
+                int row = y;
+                while (fits(rows, block, column, row + 1))
+                {
+                    ++row;
+                }
+                int rating = rate(rows, block, column, row);
+                if (rating > best)
+                {
+                    best = rating;
+                    bestRotation = rotation;
+                    bestX = column;
+                }
+            }
+        }
+        printf("place %u %d %d\n", id, bestRotation, bestX);
+        fflush(stdout);
+    }
+    return 0;
+}
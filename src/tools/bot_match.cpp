@@ -0,0 +1,106 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Plays seeded games with a bot program (see bot/bot_player.hpp) as fast   */
+/*   as the bot replies, without a screen, and reports its results and the    */
+/*   time spent waiting for it.                                               */
+/*                                                                            */
+/*   Usage: bot_match [-g games] [-p max pieces] <bot command>                */
+/*   For example: ./bot_match -g 10 ./bot_example                             */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "../bot/bot_player.hpp"
+#include "../headless.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace stc
+{
+
+// Headless platform played by the bot
+class MatchPlatform : public PlatformHeadless
+{
+public:
+    MatchPlatform(BotPlayer &bot, unsigned int seed) : PlatformHeadless(seed), mBot(bot)
+    {
+    }
+
+    void processEvents()        { mBot.play(*mGame); }
+
+private:
+    BotPlayer &mBot;
+};
+}
+
+using stc::Game;
+
+int main(int argc, char **argv)
+{
+    int games = 10;
+    int maxPieces = 1000;
+    const char *command = NULL;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-g") == 0 && i + 1 < argc)
+        {
+            games = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+        {
+            maxPieces = atoi(argv[++i]);
+        }
+        else
+        {
+            command = argv[i];
+        }
+    }
+    if (command == NULL || games <= 0 || maxPieces <= 0)
+    {
+        fprintf(stderr, "usage: %s [-g games] [-p max pieces] <bot command>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    stc::BotPlayer bot;
+    bot.setBlocking(true);
+    if (!bot.start(command))
+    {
+        fprintf(stderr, "can't run %s\n", command);
+        return EXIT_FAILURE;
+    }
+
+    long pieces = 0;
+    long lines = 0;
+    unsigned long start = stc::FrameProfiler::now();
+    for (int seed = 1; seed <= games && bot.isRunning(); ++seed)
+    {
+        stc::MatchPlatform platform(bot, (unsigned int)seed);
+        Game game;
+        game.init(&platform);
+        bot.reset();
+        while (!game.isOver() && game.stats().totalPieces < maxPieces && bot.isRunning())
+        {
+            game.update();
+        }
+        printf("game %d: score %ld, lines %d, pieces %d\n", seed, game.stats().score,
+               game.stats().lines, game.stats().totalPieces);
+        pieces += game.stats().totalPieces;
+        lines += game.stats().lines;
+        game.end();
+    }
+    double seconds = (stc::FrameProfiler::now() - start) / 1e6;
+    if (!bot.isRunning())
+    {
+        fprintf(stderr, "the bot exited\n");
+    }
+
+    printf("pieces %ld, lines %ld, %.1f pieces/s\n", pieces, lines, pieces / seconds);
+    printf("states %ld, predicted states used %ld, waiting %.3f s of %.3f s\n",
+           bot.statesSent(), bot.predictionsUsed(), bot.waitTime() / 1e6, seconds);
+    bot.stop();
+    return EXIT_SUCCESS;
+}
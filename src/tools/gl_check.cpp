@@ -0,0 +1,181 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   OpenGL renderer check.                                                   */
+/*   Plays a scripted game with fixed times and random numbers through the    */
+/*   SDL renderer or (with --gl) the OpenGL renderer, and prints a checksum   */
+/*   of the screen after every frame. Both renderers must print the same      */
+/*   checksums. "make check_gl" runs both and compares them, with OpenGL      */
+/*   on Mesa's software rasterizer (llvmpipe) in a virtual X server.          */
+/*                                                                            */
+/*   Usage: gl_check [--gl] [frames]                                          */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "../sdl/sdl_game_gl.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace stc
+{
+
+// Moves of the falling tetromino, one per frame, the last one drops it
+static const int SCRIPT[] =
+{
+    Game::EVENT_MOVE_LEFT, Game::EVENT_ROTATE_CW, Game::EVENT_NONE,
+    Game::EVENT_MOVE_LEFT, Game::EVENT_MOVE_DOWN, Game::EVENT_NONE,
+    Game::EVENT_MOVE_RIGHT, Game::EVENT_ROTATE_CW, Game::EVENT_MOVE_RIGHT,
+    Game::EVENT_MOVE_RIGHT, Game::EVENT_NONE, Game::EVENT_DROP
+};
+static const int SCRIPT_LENGTH = (int)(sizeof(SCRIPT) / sizeof(SCRIPT[0]));
+
+// Every frame advances the clock by the rest time of the platform
+static const int FRAME_TIME = 40;
+
+// Renderer playing the script with a fixed clock and seed, so every
+// renderer draws the same frames
+template <class Renderer>
+class CheckPlatform : public Renderer
+{
+public:
+    CheckPlatform()
+    {
+        mFrame = 0;
+        mSeed = 1;
+        this->setBenchmark(true);
+    }
+
+    virtual void processEvents()
+    {
+        int event = SCRIPT[mFrame % SCRIPT_LENGTH];
+        ++mFrame;
+        if (event != Game::EVENT_NONE)
+        {
+            this->mGame->onEventStart(event);
+            this->mGame->onEventEnd(event);
+        }
+    }
+
+    virtual long getSystemTime()    { return (long)mFrame * FRAME_TIME; }
+    virtual int random()            { return Replay::random(mSeed); }
+
+private:
+    int          mFrame;
+    unsigned int mSeed;
+};
+}
+
+using stc::Game;
+
+// FNV-1a hash of the pixels of the screen as RGB bytes, top row first
+static unsigned int checksum(const std::vector<Uint8> &rgb)
+{
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < rgb.size(); ++i)
+    {
+        hash = (hash ^ rgb[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Read the screen drawn by the SDL renderer
+static void readSdlScreen(std::vector<Uint8> &rgb)
+{
+    SDL_Surface *screen = SDL_GetVideoSurface();
+    SDL_LockSurface(screen);
+    for (int y = 0; y < screen->h; ++y)
+    {
+        const Uint8 *row = (const Uint8 *)screen->pixels + y * screen->pitch;
+        for (int x = 0; x < screen->w; ++x)
+        {
+            Uint32 pixel = 0;
+            memcpy(&pixel, row + x * screen->format->BytesPerPixel, screen->format->BytesPerPixel);
+            Uint8 *target = &rgb[3 * (y * screen->w + x)];
+            SDL_GetRGB(pixel, screen->format, &target[0], &target[1], &target[2]);
+        }
+    }
+    SDL_UnlockSurface(screen);
+}
+
+// Read the screen shown by the OpenGL renderer, OpenGL rows go up
+static void readGlScreen(std::vector<Uint8> &rgb)
+{
+    const int width = stc::PlatformSdl::SCREEN_WIDTH;
+    const int height = stc::PlatformSdl::SCREEN_HEIGHT;
+    std::vector<Uint8> pixels(4 * width * height);
+    glReadBuffer(GL_FRONT);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, &pixels[0]);
+    for (int y = 0; y < height; ++y)
+    {
+        for (int x = 0; x < width; ++x)
+        {
+            const Uint8 *source = &pixels[4 * ((height - 1 - y) * width + x)];
+            Uint8 *target = &rgb[3 * (y * width + x)];
+            target[0] = source[0];
+            target[1] = source[1];
+            target[2] = source[2];
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bool useGl = false;
+    int frames = 600;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--gl") == 0)
+        {
+            useGl = true;
+        }
+        else
+        {
+            frames = atoi(argv[i]);
+        }
+    }
+    if (frames <= 0)
+    {
+        fprintf(stderr, "usage: %s [--gl] [frames]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    stc::CheckPlatform<stc::PlatformSdl> sdlPlatform;
+    stc::CheckPlatform<stc::PlatformSdlGl> glPlatform;
+    stc::Platform *platform = useGl? (stc::Platform *)&glPlatform : (stc::Platform *)&sdlPlatform;
+
+    Game game;
+    game.init(platform);
+    if (game.errorCode() != Game::ERROR_NONE)
+    {
+        fprintf(stderr, "can't start the game (error %d), run from the bin folder\n", game.errorCode());
+        return EXIT_FAILURE;
+    }
+    if (useGl)
+    {
+        // The check script makes sure this is the software rasterizer
+        fprintf(stderr, "renderer: %s\n", (const char *)glGetString(GL_RENDERER));
+    }
+
+    std::vector<Uint8> rgb(3 * stc::PlatformSdl::SCREEN_WIDTH * stc::PlatformSdl::SCREEN_HEIGHT);
+    for (int f = 0; f < frames && !game.isOver(); ++f)
+    {
+        game.update();
+        if (useGl)
+        {
+            readGlScreen(rgb);
+        }
+        else
+        {
+            readSdlScreen(rgb);
+        }
+        printf("frame %d %08x\n", f, checksum(rgb));
+    }
+    game.end();
+    return EXIT_SUCCESS;
+}
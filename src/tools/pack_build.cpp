@@ -0,0 +1,147 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Asset pack builder.                                                      */
+/*   Writes the asset files in a single pack file (see AssetPack), the        */
+/*   assets keep the names given in the command line. It can also write the   */
+/*   pack as a C++ source for building it into the program.                   */
+/*                                                                            */
+/*   Usage: pack_build [-c source.cpp] <pack file> <asset files...>           */
+/*   Run it from the bin folder, for example:                                 */
+/*       ./pack_build assets.pak assets/blocks.png assets/back.png ...        */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "../pack.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using stc::AssetPack;
+
+// Bytes per line in the C++ source
+static const int SOURCE_LINE_BYTES = 16;
+
+// Append a 32 bits little endian integer
+static void putInt(std::vector<unsigned char> &pack, size_t position, unsigned int value)
+{
+    pack[position] = (unsigned char)value;
+    pack[position + 1] = (unsigned char)(value >> 8);
+    pack[position + 2] = (unsigned char)(value >> 16);
+    pack[position + 3] = (unsigned char)(value >> 24);
+}
+
+// Append the contents of a file, return false on error
+static bool readFile(const char *file, std::vector<unsigned char> &data)
+{
+    FILE *input = fopen(file, "rb");
+    if (input == NULL)
+    {
+        return false;
+    }
+    unsigned char buffer[4096];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), input)) > 0)
+    {
+        data.insert(data.end(), buffer, buffer + count);
+    }
+    bool ok = (ferror(input) == 0);
+    fclose(input);
+    return ok;
+}
+
+// Write the pack as an array of a C++ source, return false on error
+static bool writeSource(const char *file, const std::vector<unsigned char> &pack)
+{
+    FILE *output = fopen(file, "w");
+    if (output == NULL)
+    {
+        return false;
+    }
+    fprintf(output, "// Asset pack generated by pack_build, don't edit it.\n\n");
+    fprintf(output, "namespace stc\n{\n");
+    fprintf(output, "extern const unsigned char stcAssetPack[] =\n{");
+    for (size_t i = 0; i < pack.size(); ++i)
+    {
+        fprintf(output, (i % SOURCE_LINE_BYTES == 0)? "\n    %u," : " %u,", pack[i]);
+    }
+    fprintf(output, "\n};\n\n");
+    fprintf(output, "extern const unsigned long stcAssetPackSize = %lu;\n}\n", (unsigned long)pack.size());
+    return fclose(output) == 0;
+}
+
+int main(int argc, char **argv)
+{
+    const char *sourceFile = NULL;
+    int first = 1;
+    if (argc > 2 && strcmp(argv[1], "-c") == 0)
+    {
+        sourceFile = argv[2];
+        first = 3;
+    }
+    if (argc - first < 2)
+    {
+        fprintf(stderr, "usage: %s [-c source.cpp] <pack file> <asset files...>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    const char *packFile = argv[first];
+    int count = argc - first - 1;
+    char **assets = argv + first + 1;
+
+    // Header and entries, the data offsets are filled while adding the files
+    std::vector<unsigned char> pack(AssetPack::HEADER_SIZE + AssetPack::ENTRY_SIZE * count, 0);
+    memcpy(&pack[0], AssetPack::MAGIC, AssetPack::MAGIC_LENGTH);
+    putInt(pack, AssetPack::MAGIC_LENGTH, (unsigned int)count);
+
+    for (int i = 0; i < count; ++i)
+    {
+        size_t entry = AssetPack::HEADER_SIZE + AssetPack::ENTRY_SIZE * i;
+        if (strlen(assets[i]) >= (size_t)AssetPack::NAME_LENGTH)
+        {
+            fprintf(stderr, "asset name too long: %s\n", assets[i]);
+            return EXIT_FAILURE;
+        }
+        memcpy(&pack[entry], assets[i], strlen(assets[i]));
+
+        // Every asset starts aligned
+        while (pack.size() % AssetPack::DATA_ALIGNMENT != 0)
+        {
+            pack.push_back(0);
+        }
+        size_t offset = pack.size();
+        if (!readFile(assets[i], pack))
+        {
+            fprintf(stderr, "can't read asset: %s\n", assets[i]);
+            return EXIT_FAILURE;
+        }
+        putInt(pack, entry + AssetPack::NAME_LENGTH, (unsigned int)offset);
+        putInt(pack, entry + AssetPack::NAME_LENGTH + 4, (unsigned int)(pack.size() - offset));
+    }
+
+    FILE *output = fopen(packFile, "wb");
+    if (output == NULL || fwrite(&pack[0], 1, pack.size(), output) != pack.size()
+            || fclose(output) != 0)
+    {
+        fprintf(stderr, "can't write pack: %s\n", packFile);
+        return EXIT_FAILURE;
+    }
+    if (sourceFile != NULL && !writeSource(sourceFile, pack))
+    {
+        fprintf(stderr, "can't write source: %s\n", sourceFile);
+        return EXIT_FAILURE;
+    }
+
+    // Check the pack with the reader used by the game
+    AssetPack reader;
+    if (!reader.open(packFile))
+    {
+        fprintf(stderr, "invalid pack: %s\n", packFile);
+        return EXIT_FAILURE;
+    }
+    fprintf(stderr, "%d assets, %lu bytes\n", count, (unsigned long)pack.size());
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,347 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Replay to video exporter.                                                */
+/*   Plays a replay without a screen and writes the frames as a Y4M video,    */
+/*   with the layout of the game screen (see PlatformSdl). The game is        */
+/*   played in the main thread while worker threads draw the frames and       */
+/*   convert them to YUV, the frames are written in order.                    */
+/*                                                                            */
+/*   Usage: replay_y4m [-t threads] [-r fps] <replay file> [output.y4m]       */
+/*   The video is written to the standard output if there is no output file.  */
+/*   Run it from the bin folder, for example:                                 */
+/*       ./stc++ --record game.rep                                            */
+/*       ./replay_y4m game.rep | ffmpeg -i - game.mp4                         */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "../sdl/sdl_game_soft.hpp"
+#include <SDL_thread.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Frame size, the same as the game screen
+static const int FRAME_WIDTH  = stc::PlatformSdl::SCREEN_WIDTH;
+static const int FRAME_HEIGHT = stc::PlatformSdl::SCREEN_HEIGHT;
+
+// Bytes of a frame in YUV 4:2:0
+static const int FRAME_SIZE = FRAME_WIDTH * FRAME_HEIGHT * 3 / 2;
+
+// Default options
+static const int DEFAULT_THREADS = 4;
+static const int DEFAULT_FPS     = 25;
+static const int MAX_THREADS     = 64;
+
+// Frames being drawn or waiting to be written per worker thread
+static const int SLOTS_PER_THREAD = 2;
+
+// State of a frame slot
+enum
+{
+    SLOT_FREE,
+    SLOT_QUEUED,
+    SLOT_DONE
+};
+
+// Game state to draw and the converted frame
+struct FrameSlot
+{
+    stc::Game game;
+    std::vector<Uint8> yuv;
+    int state;
+};
+
+// Data shared by the main thread and the workers
+struct Pipeline
+{
+    std::vector<FrameSlot> slots;
+    SDL_mutex *mutex;
+    SDL_cond  *queued;    // signaled when a frame is queued or the pipeline ends
+    SDL_cond  *done;      // signaled when a frame is converted
+    int  submitted;       // frames queued by the main thread
+    int  taken;           // frames taken by the workers
+    bool finished;
+};
+
+// Worker thread data, every worker has its own renderer
+struct Worker
+{
+    Pipeline *pipeline;
+    SDL_Thread *thread;
+    stc::Game snapshot;
+    stc::PlatformSdlSoft renderer;
+    std::vector<uint32_t> pixels;
+    int error;
+};
+
+// Convert a frame from 0xAARRGGBB pixels to YUV 4:2:0 (full range BT.601)
+static void convertFrame(const uint32_t *pixels, Uint8 *yuv)
+{
+    Uint8 *planeY = yuv;
+    Uint8 *planeU = yuv + FRAME_WIDTH * FRAME_HEIGHT;
+    Uint8 *planeV = planeU + (FRAME_WIDTH / 2) * (FRAME_HEIGHT / 2);
+
+    for (int y = 0; y < FRAME_HEIGHT; y += 2)
+    {
+        for (int x = 0; x < FRAME_WIDTH; x += 2)
+        {
+            int sumR = 0;
+            int sumG = 0;
+            int sumB = 0;
+            for (int j = 0; j < 2; ++j)
+            {
+                for (int i = 0; i < 2; ++i)
+                {
+                    uint32_t pixel = pixels[(y + j) * FRAME_WIDTH + x + i];
+                    int r = (pixel >> 16) & 0xff;
+                    int g = (pixel >> 8) & 0xff;
+                    int b = pixel & 0xff;
+                    planeY[(y + j) * FRAME_WIDTH + x + i] = (Uint8)((77 * r + 150 * g + 29 * b + 128) >> 8);
+                    sumR += r;
+                    sumG += g;
+                    sumB += b;
+                }
+            }
+            // Average of the four pixels (the sums are four times bigger)
+            int chroma = (y / 2) * (FRAME_WIDTH / 2) + x / 2;
+            planeU[chroma] = (Uint8)(((-43 * sumR - 85 * sumG + 128 * sumB + 512) >> 10) + 128);
+            planeV[chroma] = (Uint8)(((128 * sumR - 107 * sumG - 21 * sumB + 512) >> 10) + 128);
+        }
+    }
+}
+
+// Worker thread, draws and converts the queued frames
+static int workerMain(void *data)
+{
+    Worker *worker = (Worker *)data;
+    Pipeline *pipeline = worker->pipeline;
+
+    stc::StcImage frame;
+    frame.pixels = &worker->pixels[0];
+    frame.width = FRAME_WIDTH;
+    frame.height = FRAME_HEIGHT;
+    frame.pitch = FRAME_WIDTH;
+
+    for (;;)
+    {
+        SDL_mutexP(pipeline->mutex);
+        while (pipeline->taken == pipeline->submitted && !pipeline->finished)
+        {
+            SDL_CondWait(pipeline->queued, pipeline->mutex);
+        }
+        if (pipeline->taken == pipeline->submitted)
+        {
+            SDL_mutexV(pipeline->mutex);
+            return 0;
+        }
+        FrameSlot &slot = pipeline->slots[pipeline->taken++ % pipeline->slots.size()];
+        worker->snapshot = slot.game;
+        SDL_mutexV(pipeline->mutex);
+
+        worker->renderer.drawFrame(frame);
+        convertFrame(frame.pixels, &slot.yuv[0]);
+
+        SDL_mutexP(pipeline->mutex);
+        slot.state = SLOT_DONE;
+        SDL_CondBroadcast(pipeline->done);
+        SDL_mutexV(pipeline->mutex);
+    }
+}
+
+// Wait until a slot is converted and write it, return false on error
+static bool writeSlot(Pipeline &pipeline, FrameSlot &slot, FILE *output)
+{
+    SDL_mutexP(pipeline.mutex);
+    while (slot.state == SLOT_QUEUED)
+    {
+        SDL_CondWait(pipeline.done, pipeline.mutex);
+    }
+    SDL_mutexV(pipeline.mutex);
+
+    if (slot.state == SLOT_DONE)
+    {
+        slot.state = SLOT_FREE;
+        if (fputs("FRAME\n", output) < 0
+                || fwrite(&slot.yuv[0], 1, FRAME_SIZE, output) != (size_t)FRAME_SIZE)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Stop the started workers, release them and the pipeline
+static void stopWorkers(Pipeline &pipeline, std::vector<Worker *> &workers)
+{
+    SDL_mutexP(pipeline.mutex);
+    pipeline.finished = true;
+    SDL_CondBroadcast(pipeline.queued);
+    SDL_mutexV(pipeline.mutex);
+    for (size_t i = 0; i < workers.size(); ++i)
+    {
+        SDL_WaitThread(workers[i]->thread, NULL);
+        workers[i]->renderer.endHeadless();
+        delete workers[i];
+    }
+    workers.clear();
+    SDL_DestroyCond(pipeline.queued);
+    SDL_DestroyCond(pipeline.done);
+    SDL_DestroyMutex(pipeline.mutex);
+}
+
+int main(int argc, char **argv)
+{
+    int threads = DEFAULT_THREADS;
+    int fps = DEFAULT_FPS;
+    const char *replayFile = NULL;
+    const char *videoFile = NULL;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc)
+        {
+            threads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc)
+        {
+            fps = atoi(argv[++i]);
+        }
+        else if (replayFile == NULL)
+        {
+            replayFile = argv[i];
+        }
+        else
+        {
+            videoFile = argv[i];
+        }
+    }
+    if (replayFile == NULL || threads < 1 || threads > MAX_THREADS || fps < 1 || fps > 1000)
+    {
+        fprintf(stderr, "usage: %s [-t threads] [-r fps] <replay file> [output.y4m]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    stc::Replay replay;
+    if (!replay.load(replayFile))
+    {
+        fprintf(stderr, "can't load replay: %s\n", replayFile);
+        return EXIT_FAILURE;
+    }
+    FILE *output = (videoFile != NULL)? fopen(videoFile, "wb") : stdout;
+    if (output == NULL)
+    {
+        fprintf(stderr, "can't create video: %s\n", videoFile);
+        return EXIT_FAILURE;
+    }
+
+    // Start the workers, each one loads its own images
+    Pipeline pipeline;
+    pipeline.slots.resize(SLOTS_PER_THREAD * threads);
+    for (size_t i = 0; i < pipeline.slots.size(); ++i)
+    {
+        pipeline.slots[i].yuv.resize(FRAME_SIZE);
+        pipeline.slots[i].state = SLOT_FREE;
+    }
+    pipeline.mutex = SDL_CreateMutex();
+    pipeline.queued = SDL_CreateCond();
+    pipeline.done = SDL_CreateCond();
+    pipeline.submitted = 0;
+    pipeline.taken = 0;
+    pipeline.finished = false;
+
+    std::vector<Worker *> workers;
+    for (int i = 0; i < threads; ++i)
+    {
+        Worker *worker = new Worker;
+        worker->pipeline = &pipeline;
+        worker->pixels.resize(FRAME_WIDTH * FRAME_HEIGHT);
+        worker->error = worker->renderer.initHeadless(&worker->snapshot);
+        if (worker->error != stc::Game::ERROR_NONE)
+        {
+            fprintf(stderr, "can't load images, run from the bin folder\n");
+            worker->renderer.endHeadless();
+            delete worker;
+            stopWorkers(pipeline, workers);
+            if (output != stdout)
+            {
+                fclose(output);
+            }
+            return EXIT_FAILURE;
+        }
+        worker->thread = SDL_CreateThread(workerMain, worker);
+        if (worker->thread == NULL)
+        {
+            fprintf(stderr, "can't start the render threads\n");
+            worker->renderer.endHeadless();
+            delete worker;
+            stopWorkers(pipeline, workers);
+            if (output != stdout)
+            {
+                fclose(output);
+            }
+            return EXIT_FAILURE;
+        }
+        workers.push_back(worker);
+    }
+
+    fprintf(output, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg\n", FRAME_WIDTH, FRAME_HEIGHT, fps);
+
+    // Play the replay and queue a frame every video tick
+    stc::Game game;
+    stc::PlatformReplay platform(replay);
+    game.init(&platform);
+
+    bool ok = true;
+    int frames = 0;
+    for (long tick = 0; ok; ++tick)
+    {
+        long time = replay.startTime() + tick * 1000 / fps;
+        while (!platform.isFinished() && platform.nextTime() <= time
+                && game.errorCode() == stc::Game::ERROR_NONE)
+        {
+            game.update();
+        }
+
+        // Slots are used in order, so the frames are written in order
+        FrameSlot &slot = pipeline.slots[frames % pipeline.slots.size()];
+        ok = writeSlot(pipeline, slot, output);
+        slot.game = game;
+
+        SDL_mutexP(pipeline.mutex);
+        slot.state = SLOT_QUEUED;
+        ++pipeline.submitted;
+        SDL_CondSignal(pipeline.queued);
+        SDL_mutexV(pipeline.mutex);
+        ++frames;
+
+        if (platform.isFinished() || game.errorCode() != stc::Game::ERROR_NONE)
+        {
+            break;
+        }
+    }
+
+    // Write the frames left and stop the workers
+    for (int i = 0; i < (int)pipeline.slots.size(); ++i)
+    {
+        FrameSlot &slot = pipeline.slots[(frames + i) % pipeline.slots.size()];
+        ok = writeSlot(pipeline, slot, output) && ok;
+    }
+    stopWorkers(pipeline, workers);
+
+    if (output != stdout)
+    {
+        ok = (fclose(output) == 0) && ok;
+    }
+    if (!ok)
+    {
+        fprintf(stderr, "can't write video\n");
+        return EXIT_FAILURE;
+    }
+    fprintf(stderr, "%d frames written\n", frames);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,150 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Example bot using the shared memory state of a running game.             */
+/*   It reads the newest snapshot without system calls, moves every new       */
+/*   tetromino (without rotating it) to the column where it lands lowest      */
+/*   and drops it. It sends a key press every two frames of the game, so the  */
+/*   next snapshot it reads already shows the result of the previous key.     */
+/*                                                                            */
+/*   Usage: shm_bot [name]                                                    */
+/*   Start the game first, for example:                                       */
+/*       ./stc++ --shm /stc &                                                 */
+/*       ./shm_bot /stc                                                       */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "../shm/shm_state.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <unistd.h>
+
+using stc::Game;
+using stc::SharedState;
+using stc::StcSharedSnapshot;
+
+// Time between reads of the state, in microseconds
+static const int POLL_TIME = 1000;
+
+// Return true if the falling tetromino of [snapshot] fits at (x, y)
+static bool fits(const StcSharedSnapshot &snapshot, int x, int y)
+{
+    for (int j = 0; j < Game::TETROMINO_SIZE; ++j)
+    {
+        for (int i = 0; i < Game::TETROMINO_SIZE; ++i)
+        {
+            if ((snapshot.fallingCells & (1u << (i + Game::TETROMINO_SIZE * j))) == 0)
+            {
+                continue;
+            }
+            int column = x + i;
+            int row = y + j;
+            if (column < 0 || column >= Game::BOARD_TILEMAP_WIDTH || row >= Game::BOARD_TILEMAP_HEIGHT)
+            {
+                return false;
+            }
+            if (row >= 0 && (snapshot.rows[row] & (1u << column)) != 0)
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Return the column where the falling tetromino lands lowest
+static int findColumn(const StcSharedSnapshot &snapshot)
+{
+    int best = snapshot.fallingX;
+    int bestRow = -1;
+    for (int x = -Game::TETROMINO_SIZE; x < Game::BOARD_TILEMAP_WIDTH; ++x)
+    {
+        if (!fits(snapshot, x, snapshot.fallingY))
+        {
+            continue;
+        }
+        int y = snapshot.fallingY;
+        while (fits(snapshot, x, y + 1))
+        {
+            ++y;
+        }
+        if (y > bestRow)
+        {
+            bestRow = y;
+            best = x;
+        }
+    }
+    return best;
+}
+
+// Press and release a key
+static void sendKey(SharedState &state, int event)
+{
+    state.pushInput(true, event);
+    state.pushInput(false, event);
+}
+
+int main(int argc, char **argv)
+{
+    const char *name = (argc > 1)? argv[1] : "/stc";
+    SharedState state;
+    if (!state.attach(name))
+    {
+        fprintf(stderr, "can't attach to %s, start the game with --shm %s\n", name, name);
+        return EXIT_FAILURE;
+    }
+
+    StcSharedSnapshot snapshot;
+    unsigned int lastTick = 0;
+    int piece = -1;
+    int target = 0;
+    bool dropped = false;
+    unsigned int keyTick = 0;
+    for (;;)
+    {
+        if (!state.readLatest(&snapshot) || snapshot.tick == lastTick)
+        {
+            usleep(POLL_TIME);
+            continue;
+        }
+        lastTick = snapshot.tick;
+        if ((snapshot.flags & (SharedState::SNAPSHOT_OVER | SharedState::SNAPSHOT_PAUSED)) != 0)
+        {
+            continue;
+        }
+
+        // Plan every new tetromino once
+        if (snapshot.totalPieces != piece)
+        {
+            piece = snapshot.totalPieces;
+            target = findColumn(snapshot);
+            dropped = false;
+            printf("piece %d type %d: column %d, score %ld\n", piece,
+                   snapshot.fallingType, target, (long)snapshot.score);
+            fflush(stdout);
+        }
+
+        // Wait for the next tetromino or for the last key to be used
+        if (dropped || snapshot.tick < keyTick + 2)
+        {
+            continue;
+        }
+        keyTick = snapshot.tick;
+        if (snapshot.fallingX < target)
+        {
+            sendKey(state, Game::EVENT_MOVE_RIGHT);
+        }
+        else if (snapshot.fallingX > target)
+        {
+            sendKey(state, Game::EVENT_MOVE_LEFT);
+        }
+        else
+        {
+            sendKey(state, Game::EVENT_DROP);
+            dropped = true;
+        }
+    }
+}
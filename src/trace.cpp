@@ -0,0 +1,210 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Tracing: spans of the engine and platform work in every thread.          */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#include "trace.hpp"
+#include "profile.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+#if defined(_MSC_VER)
+#include <windows.h>
+#define STC_THREAD_LOCAL            __declspec(thread)
+#define STC_TRACE_BARRIER()         MemoryBarrier()
+#define STC_ATOMIC_INCREMENT(value) InterlockedIncrement(value)
+#define STC_ATOMIC_SWAP_POINTER(target, old, value) \
+        (InterlockedCompareExchangePointer((void *volatile *)(target), (value), (old)) == (old))
+#else
+#define STC_THREAD_LOCAL            __thread
+#define STC_TRACE_BARRIER()         __sync_synchronize()
+#define STC_ATOMIC_INCREMENT(value) __sync_add_and_fetch(value, 1)
+#define STC_ATOMIC_SWAP_POINTER(target, old, value) \
+        __sync_bool_compare_and_swap(target, old, value)
+#endif
+
+namespace stc
+{
+
+// A recorded span
+struct StcTraceSpan
+{
+    const char   *name;
+    unsigned long start;
+    unsigned long duration;
+};
+
+// Spans of a thread
+struct StcTraceBuffer
+{
+    StcTraceSpan   *spans;
+    volatile long   count;      // published spans, written by the owner only
+    long            dropped;    // spans lost because the buffer was full
+    const char     *threadName;
+    long            threadId;
+    StcTraceBuffer *next;
+};
+
+// Buffer of the calling thread
+static STC_THREAD_LOCAL StcTraceBuffer *tBuffer = NULL;
+
+// All the buffers, new ones are pushed at the front
+static StcTraceBuffer *volatile gBuffers = NULL;
+
+static volatile long gThreadCount = 0;
+static volatile bool gRecording = false;
+static unsigned long gStartTime = 0;
+
+// Return the buffer of the calling thread, create it if needed
+static StcTraceBuffer *threadBuffer()
+{
+    if (tBuffer != NULL)
+    {
+        return tBuffer;
+    }
+    StcTraceBuffer *buffer = (StcTraceBuffer *)malloc(sizeof(StcTraceBuffer));
+    if (buffer == NULL)
+    {
+        return NULL;
+    }
+    buffer->spans = (StcTraceSpan *)malloc(Tracer::BUFFER_SPANS * sizeof(StcTraceSpan));
+    if (buffer->spans == NULL)
+    {
+        free(buffer);
+        return NULL;
+    }
+    buffer->count = 0;
+    buffer->dropped = 0;
+    buffer->threadName = NULL;
+    buffer->threadId = STC_ATOMIC_INCREMENT(&gThreadCount);
+
+    // Publish the buffer
+    StcTraceBuffer *head;
+    do
+    {
+        head = gBuffers;
+        buffer->next = head;
+    }
+    while (!STC_ATOMIC_SWAP_POINTER(&gBuffers, head, buffer));
+
+    tBuffer = buffer;
+    return buffer;
+}
+
+// Start recording
+void Tracer::start()
+{
+    gStartTime = FrameProfiler::now();
+    STC_TRACE_BARRIER();
+    gRecording = true;
+    setThreadName("main");
+}
+
+// Stop recording
+void Tracer::stop()
+{
+    gRecording = false;
+    STC_TRACE_BARRIER();
+}
+
+// Return true while recording
+bool Tracer::isRecording()
+{
+    return gRecording;
+}
+
+// Record a span of the calling thread
+void Tracer::record(const char *name, unsigned long start, unsigned long duration)
+{
+    StcTraceBuffer *buffer = threadBuffer();
+    if (buffer == NULL)
+    {
+        return;
+    }
+    long count = buffer->count;
+    if (count >= BUFFER_SPANS)
+    {
+        ++buffer->dropped;
+        return;
+    }
+    StcTraceSpan &span = buffer->spans[count];
+    span.name = name;
+    span.start = start;
+    span.duration = duration;
+
+    // The span must be written before it's counted
+    STC_TRACE_BARRIER();
+    buffer->count = count + 1;
+}
+
+// Name the calling thread
+void Tracer::setThreadName(const char *name)
+{
+    if (!gRecording)
+    {
+        return;
+    }
+    StcTraceBuffer *buffer = threadBuffer();
+    if (buffer != NULL)
+    {
+        buffer->threadName = name;
+    }
+}
+
+// Write the recorded spans of all the threads as Chrome trace events
+bool Tracer::write(const char *file)
+{
+    FILE *output = fopen(file, "w");
+    if (output == NULL)
+    {
+        return false;
+    }
+    fprintf(output, "{\"traceEvents\":[\n");
+    bool first = true;
+    long dropped = 0;
+    for (StcTraceBuffer *buffer = gBuffers; buffer != NULL; buffer = buffer->next)
+    {
+        long count = buffer->count;
+        STC_TRACE_BARRIER();
+
+        if (buffer->threadName != NULL)
+        {
+            fprintf(output, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%ld,"
+                    "\"args\":{\"name\":\"%s\"}}", first? "" : ",\n",
+                    buffer->threadId, buffer->threadName);
+            first = false;
+        }
+        for (long i = 0; i < count; ++i)
+        {
+            const StcTraceSpan &span = buffer->spans[i];
+            fprintf(output, "%s{\"name\":\"%s\",\"cat\":\"stc\",\"ph\":\"X\",\"ts\":%lu,"
+                    "\"dur\":%lu,\"pid\":1,\"tid\":%ld}", first? "" : ",\n", span.name,
+                    span.start - gStartTime, span.duration, buffer->threadId);
+            first = false;
+        }
+        dropped += buffer->dropped;
+    }
+    fprintf(output, "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedSpans\":%ld}}\n", dropped);
+    return fclose(output) == 0;
+}
+
+TraceSpan::TraceSpan(const char *name)
+{
+    mName = name;
+    mRecording = Tracer::isRecording();
+    mStart = mRecording? FrameProfiler::now() : 0;
+}
+
+TraceSpan::~TraceSpan()
+{
+    if (mRecording)
+    {
+        Tracer::record(mName, mStart, FrameProfiler::now() - mStart);
+    }
+}
+}
@@ -0,0 +1,77 @@
+/* ========================================================================== */
+/*                          STC - SIMPLE TETRIS CLONE                         */
+/* -------------------------------------------------------------------------- */
+/*   Tracing: spans of the engine and platform work in every thread, written  */
+/*   as Chrome trace events (open them in chrome://tracing or Perfetto).      */
+/*                                                                            */
+/*   The spans are compiled only if STC_TRACE is defined, and recorded only   */
+/*   between Tracer::start() and Tracer::stop().                              */
+/*                                                                            */
+/*   Copyright (c) 2013 Laurens Rodriguez Oscanoa.                            */
+/*   This code is licensed under the MIT license:                             */
+/*   http://www.opensource.org/licenses/mit-license.php                       */
+/* -------------------------------------------------------------------------- */
+
+#ifndef STC_SRC_TRACE_HPP_
+#define STC_SRC_TRACE_HPP_
+
+#ifdef STC_TRACE
+// Record a span from this line to the end of the enclosing block
+#define STC_TRACE_SPAN(name)    stc::TraceSpan stcTraceSpan(name)
+// Name the calling thread in the trace
+#define STC_TRACE_THREAD(name)  stc::Tracer::setThreadName(name)
+#else
+#define STC_TRACE_SPAN(name)
+#define STC_TRACE_THREAD(name)
+#endif
+
+namespace stc
+{
+
+// Records spans in a buffer per thread. Only the owner thread writes in a
+// buffer, so recording takes no locks. A buffer is created the first time
+// its thread records a span and it's kept until the program exits, so the
+// spans of finished threads can still be written.
+class Tracer
+{
+public:
+    // Spans kept per thread, the spans after these are dropped
+    static const int BUFFER_SPANS = 1 << 16;
+
+    // Start recording, the calling thread is named "main"
+    static void start();
+
+    // Stop recording
+    static void stop();
+
+    // Return true while recording
+    static bool isRecording();
+
+    // Record a span of the calling thread, [name] must be a constant string.
+    // Times are in microseconds of FrameProfiler::now().
+    static void record(const char *name, unsigned long start, unsigned long duration);
+
+    // Name the calling thread, [name] must be a constant string
+    static void setThreadName(const char *name);
+
+    // Write the recorded spans of all the threads as Chrome trace events,
+    // return false on error. Call it after stopping.
+    static bool write(const char *file);
+};
+
+// Span that lasts the lifetime of the object
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name);
+    ~TraceSpan();
+
+private:
+
+    const char   *mName;
+    unsigned long mStart;
+    bool          mRecording;
+};
+}
+
+#endif // STC_SRC_TRACE_HPP_